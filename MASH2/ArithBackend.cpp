@@ -0,0 +1,189 @@
+#include "ArithBackend.h"
+#include <cstdlib>
+#include <cstring>
+
+// BigInteger behind the backend interface. Every operation builds its result
+// before assigning it, which makes aliased destinations safe.
+class NativeBackend : public ArithBackend {
+public:
+	const char * Name() const {
+		return "native";
+	}
+
+	Handle Create() const {
+		return reinterpret_cast<Handle>(new BigInteger());
+	}
+
+	void Destroy(Handle value) const {
+		delete reinterpret_cast<BigInteger *>(value);
+	}
+
+	void Copy(Handle dst, Handle src) const {
+		Value(dst) = Value(src);
+	}
+
+	void Import(Handle dst, const uint8_t * bytes, size_t count) const {
+		vector<uint32_t> limbs((count + 3) / 4, 0);
+		for (size_t i = 0; i < count; i++) {
+			size_t bit = (count - 1 - i) * 8;
+			limbs[bit / 32] |= (uint32_t)bytes[i] << (bit % 32);
+		}
+		Value(dst) = BigInteger::FromLimbs(limbs.data(), limbs.size());
+	}
+
+	void Export(Handle src, uint8_t * bytes, size_t count) const {
+		const LimbVector & limbs = Value(src).Limbs();
+		for (size_t index = count / 4; index < limbs.size(); index++) {
+			uint32_t spill = index == count / 4 && count % 4 != 0 ? limbs[index] >> (count % 4 * 8) : limbs[index];
+			if (spill != 0) {
+				throw exception("ERROR: Value does not fit the export buffer.");
+			}
+		}
+		for (size_t i = 0; i < count; i++) {
+			size_t bit = (count - 1 - i) * 8;
+			size_t index = bit / 32;
+			bytes[i] = index < limbs.size() ? (uint8_t)(limbs[index] >> (bit % 32)) : 0;
+		}
+	}
+
+	void Add(Handle dst, Handle a, Handle b) const {
+		Value(dst) = Value(a) + Value(b);
+	}
+
+	void Sub(Handle dst, Handle a, Handle b) const {
+		Value(dst) = Value(a) - Value(b);
+	}
+
+	void Mul(Handle dst, Handle a, Handle b) const {
+		Value(dst) = Value(a) * Value(b);
+	}
+
+	void Mod(Handle dst, Handle a, Handle mod) const {
+		Value(dst) = Value(a) % Value(mod);
+	}
+
+	void MulMod(Handle dst, Handle a, Handle b, Handle mod) const {
+		Value(dst) = (Value(a) * Value(b)) % Value(mod);
+	}
+
+	void PowMod(Handle dst, Handle base, uint32_t exp, Handle mod) const {
+		Value(dst) = BigInteger::ExpMod(Value(base), BigInteger::FromLimbs(&exp, 1), Value(mod));
+	}
+
+	void ShiftLeft(Handle dst, Handle a, size_t bits) const {
+		Value(dst) = Value(a) << BigInteger((int)bits);
+	}
+
+	void LowBits(Handle dst, Handle a, size_t bits) const {
+		const LimbVector & limbs = Value(a).Limbs();
+		size_t count = (bits + 31) / 32;
+		if (count > limbs.size() || (count == limbs.size() && bits % 32 == 0)) {
+			Value(dst) = Value(a);
+			return;
+		}
+		vector<uint32_t> low(limbs.data(), limbs.data() + count);
+		if (bits % 32 != 0) {
+			low.back() &= (1u << (bits % 32)) - 1;
+		}
+		Value(dst) = BigInteger::FromLimbs(low.data(), low.size());
+	}
+
+	void Or(Handle dst, Handle a, Handle b) const {
+		Value(dst) = Value(a) | Value(b);
+	}
+
+	void Xor(Handle dst, Handle a, Handle b) const {
+		Value(dst) = Value(a) ^ Value(b);
+	}
+
+private:
+	static BigInteger & Value(Handle value) {
+		return *reinterpret_cast<BigInteger *>(value);
+	}
+};
+
+ArithNumber::ArithNumber() : m_backend(nullptr), m_handle(nullptr) {
+}
+
+ArithNumber::ArithNumber(const ArithBackend & backend) : m_backend(&backend), m_handle(backend.Create()) {
+}
+
+// Moves the value across as big-endian bytes, so any backend can take it
+ArithNumber::ArithNumber(const ArithBackend & backend, const BigInteger & value) : m_backend(&backend), m_handle(backend.Create()) {
+	const LimbVector & limbs = value.Limbs();
+	vector<uint8_t> bytes(limbs.size() * 4);
+	for (size_t i = 0; i < limbs.size(); i++) {
+		size_t pos = bytes.size() - 4 - i * 4;
+		bytes[pos] = (uint8_t)(limbs[i] >> 24);
+		bytes[pos + 1] = (uint8_t)(limbs[i] >> 16);
+		bytes[pos + 2] = (uint8_t)(limbs[i] >> 8);
+		bytes[pos + 3] = (uint8_t)limbs[i];
+	}
+	backend.Import(m_handle, bytes.data(), bytes.size());
+}
+
+ArithNumber::ArithNumber(const ArithNumber & rhs) : m_backend(rhs.m_backend), m_handle(nullptr) {
+	if (m_backend != nullptr) {
+		m_handle = m_backend->Create();
+		m_backend->Copy(m_handle, rhs.m_handle);
+	}
+}
+
+ArithNumber & ArithNumber::operator=(const ArithNumber & rhs) {
+	if (this == &rhs) {
+		return *this;
+	}
+	if (m_backend != rhs.m_backend) {
+		if (m_backend != nullptr) {
+			m_backend->Destroy(m_handle);
+		}
+		m_backend = rhs.m_backend;
+		m_handle = m_backend != nullptr ? m_backend->Create() : nullptr;
+	}
+	if (m_backend != nullptr) {
+		m_backend->Copy(m_handle, rhs.m_handle);
+	}
+	return *this;
+}
+
+ArithNumber::~ArithNumber() {
+	if (m_backend != nullptr) {
+		m_backend->Destroy(m_handle);
+	}
+}
+
+const ArithBackend & NativeArithBackend() {
+	static const NativeBackend backend;
+	return backend;
+}
+
+const ArithBackend * FindArithBackend(const char * name) {
+	if (strcmp(name, "native") == 0) {
+		return &NativeArithBackend();
+	}
+#ifdef MASH2_WITH_GMP
+	if (strcmp(name, "gmp") == 0) {
+		return &GmpArithBackend();
+	}
+#endif
+	return nullptr;
+}
+
+static const ArithBackend & SelectArithBackend() {
+	const char * requested = std::getenv("MASH2_BACKEND");
+	if (requested == nullptr) {
+		return NativeArithBackend();
+	}
+	// A typo or a build without that backend must not quietly run native instead
+	const ArithBackend * backend = FindArithBackend(requested);
+	if (backend == nullptr) {
+		throw exception("ERROR: MASH2_BACKEND names an unknown arithmetic backend, or one this build lacks.");
+	}
+	return *backend;
+}
+
+const ArithBackend & GetArithBackend() {
+	// Resolved once, on first use
+	static const ArithBackend & backend = SelectArithBackend();
+	return backend;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "BigInteger.h"
+
+// Opaque number owned by an ArithBackend. Each backend casts it to its own type.
+struct ArithValue;
+
+// The arithmetic MASH2 runs per digest, behind a swappable implementation. Values
+// are non-negative; every destination may alias any of the operands. Backends hold
+// no per-call state, so one instance serves every thread.
+//
+// The native backend runs on BigInteger. Building with MASH2_WITH_GMP (and linking
+// libgmp; msbuild /p:WithGmp=true /p:GmpDir=<prefix> does both) adds "gmp".
+// MASH2_BACKEND picks one at run time, native is the default.
+class ArithBackend {
+public:
+	typedef ArithValue * Handle;
+
+	virtual ~ArithBackend() {}
+	virtual const char * Name() const = 0;
+
+	// New values start at zero
+	virtual Handle Create() const = 0;
+	virtual void Destroy(Handle value) const = 0;
+	virtual void Copy(Handle dst, Handle src) const = 0;
+
+	// Unsigned big-endian bytes. Export writes exactly count bytes, zero-extended;
+	// the value must fit.
+	virtual void Import(Handle dst, const uint8_t * bytes, size_t count) const = 0;
+	virtual void Export(Handle src, uint8_t * bytes, size_t count) const = 0;
+
+	// Sub requires a >= b
+	virtual void Add(Handle dst, Handle a, Handle b) const = 0;
+	virtual void Sub(Handle dst, Handle a, Handle b) const = 0;
+	virtual void Mul(Handle dst, Handle a, Handle b) const = 0;
+	virtual void Mod(Handle dst, Handle a, Handle mod) const = 0;
+	virtual void MulMod(Handle dst, Handle a, Handle b, Handle mod) const = 0;
+	virtual void PowMod(Handle dst, Handle base, uint32_t exp, Handle mod) const = 0;
+
+	virtual void ShiftLeft(Handle dst, Handle a, size_t bits) const = 0;
+	// a mod 2^bits
+	virtual void LowBits(Handle dst, Handle a, size_t bits) const = 0;
+	virtual void Or(Handle dst, Handle a, Handle b) const = 0;
+	virtual void Xor(Handle dst, Handle a, Handle b) const = 0;
+};
+
+// Owns one backend value. Default constructed numbers are unbound until assigned.
+class ArithNumber {
+public:
+	ArithNumber();
+	explicit ArithNumber(const ArithBackend & backend);
+	ArithNumber(const ArithBackend & backend, const BigInteger & value);
+	ArithNumber(const ArithNumber & rhs);
+	ArithNumber & operator=(const ArithNumber & rhs);
+	~ArithNumber();
+
+	ArithBackend::Handle Get() const {
+		return m_handle;
+	}
+private:
+	const ArithBackend * m_backend;
+	ArithBackend::Handle m_handle;
+};
+
+const ArithBackend & NativeArithBackend();
+#ifdef MASH2_WITH_GMP
+const ArithBackend & GmpArithBackend();
+#endif
+// "native" or "gmp"; null when the name is unknown or not compiled in
+const ArithBackend * FindArithBackend(const char * name);
+// Resolved once from MASH2_BACKEND, native when unset. Throws when it names a
+// backend that is unknown or not compiled in.
+const ArithBackend & GetArithBackend();
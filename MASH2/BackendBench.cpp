@@ -0,0 +1,62 @@
+#include "BackendBench.h"
+#include "Trace.h"
+#include <random>
+
+// Seeded so every run, and every backend, sees the same messages
+#define BENCH_SEED 0x4d415348
+// Mismatches listed in full before the rest are only counted
+#define BENCH_MAX_REPORTED 10
+
+// Digests every message with one backend and returns the elapsed seconds.
+static double TimeDigests(MASH2 & hash, const vector<string> & messages, vector<string> & digests) {
+	digests.clear();
+	digests.reserve(messages.size());
+	uint64_t start = Trace::NowNs();
+	for (size_t i = 0; i < messages.size(); i++) {
+		digests.push_back(hash.Digest(messages[i]));
+	}
+	return (Trace::NowNs() - start) / 1e9;
+}
+
+static void ReportThroughput(ostream & out, const ArithBackend & backend, size_t messages, size_t messageBytes, double seconds) {
+	out << backend.Name() << ": " << messages << " digests in " << seconds << " s, "
+		<< messages / seconds << " digests/s, " << messages * messageBytes / seconds / 1024 << " KiB/s" << std::endl;
+}
+
+BackendBenchResult BackendBench::Run(const MASH2Params & params, const ArithBackend & first, const ArithBackend & second,
+	size_t messages, size_t messageBytes, ostream & out) {
+	std::mt19937 rng(BENCH_SEED);
+	vector<string> inputs(messages, string(messageBytes, '\0'));
+	for (size_t i = 0; i < messages; i++) {
+		for (size_t j = 0; j < messageBytes; j++) {
+			inputs[i][j] = (char)rng();
+		}
+		// A non-zero leading byte keeps every message the same bit length
+		inputs[i][0] |= 0x80;
+	}
+
+	MASH2 hash(params);
+	vector<string> firstDigests, secondDigests;
+	BackendBenchResult result;
+	result.messages = messages;
+	hash.SetBackend(first);
+	result.firstSeconds = TimeDigests(hash, inputs, firstDigests);
+	hash.SetBackend(second);
+	result.secondSeconds = TimeDigests(hash, inputs, secondDigests);
+
+	ReportThroughput(out, first, messages, messageBytes, result.firstSeconds);
+	ReportThroughput(out, second, messages, messageBytes, result.secondSeconds);
+	result.mismatches = 0;
+	for (size_t i = 0; i < messages; i++) {
+		if (firstDigests[i] == secondDigests[i]) {
+			continue;
+		}
+		if (result.mismatches < BENCH_MAX_REPORTED) {
+			out << "Mismatch on message " << i << ": " << first.Name() << " " << firstDigests[i]
+				<< ", " << second.Name() << " " << secondDigests[i] << std::endl;
+		}
+		result.mismatches++;
+	}
+	out << result.mismatches << " of " << messages << " digests differ" << std::endl;
+	return result;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "MASH2.h"
+
+struct BackendBenchResult {
+	size_t messages;
+	size_t mismatches;
+	double firstSeconds;
+	double secondSeconds;
+};
+
+// Differential benchmark between two arithmetic backends. Both hash the same
+// pseudo-random messages under the same parameters and must produce the same digests.
+class BackendBench {
+public:
+	// Writes one throughput line per backend, then any mismatching messages, to out
+	static BackendBenchResult Run(const MASH2Params & params, const ArithBackend & first, const ArithBackend & second,
+		size_t messages, size_t messageBytes, ostream & out);
+};
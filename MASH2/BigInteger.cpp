@@ -1,7 +1,114 @@
 #include "BigInteger.h"
-// Optimization for comparing against 0
-const BigInteger ZERO("0");
-const BigInteger ONE("1");
+#include "LimbKernels.h"
+#include "Ntt.h"
+#include "WordMath.h"
+#include <utility>
+// Optimization for comparing against 0. Built from compile-time literals, so
+// static initialization neither parses nor allocates.
+const BigInteger ZERO(BigConstants::ZERO);
+const BigInteger ONE(BigConstants::ONE);
+const BigInteger TWO(BigConstants::TWO);
+
+// Lookup tables for radix conversion. HEX_VALUES maps an ASCII character to its
+// nibble value, or -1 when it is not a hex digit.
+static const char HEX_DIGITS[] = "0123456789abcdef";
+static const int8_t HEX_VALUES[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// Largest power of ten that fits in a limb, and how many digits it holds
+static const uint32_t DECIMAL_LIMB = 1000000000;
+static const size_t DECIMAL_LIMB_DIGITS = 9;
+// Below this many digits the decimal conversions run limb by limb instead of
+// splitting. Parsing only gains once the recombining products reach the NTT, so its
+// break-even sits much higher than printing's.
+static const size_t DECIMAL_SPLIT_DIGITS = 2000;
+static const size_t DECIMAL_PARSE_SPLIT_DIGITS = 24000;
+// ToDecimal divides by multiplying with a reciprocal once a split quotient has this
+// many limbs; Reciprocal falls back to long division at or below DECIMAL_RECIP_BASE_LIMBS
+static const size_t DECIMAL_RECIP_MIN_LIMBS = 2048;
+static const size_t DECIMAL_RECIP_BASE_LIMBS = 64;
+
+// (a * b) % mod without overflow, for a, b < mod
+static uint64_t MulMod64(uint64_t a, uint64_t b, uint64_t mod) {
+#if defined(__SIZEOF_INT128__)
+	return (uint64_t)(((unsigned __int128)a * b) % mod);
+#else
+	if (mod <= UINT32_MAX) {
+		return (a * b) % mod;
+	}
+	// Double-and-add, each step stays below 2 * mod
+	uint64_t result = 0;
+	for (a %= mod; b; b >>= 1) {
+		if (b & 1) {
+			result = (result >= mod - a) ? result - (mod - a) : result + a;
+		}
+		a = (a >= mod - a) ? a - (mod - a) : a + a;
+	}
+	return result;
+#endif
+}
+
+static uint64_t ExpMod64(uint64_t base, uint64_t exp, uint64_t mod) {
+	uint64_t result = 1 % mod;
+	for (base %= mod; exp; exp >>= 1) {
+		if (exp & 1) {
+			result = MulMod64(result, base, mod);
+		}
+		base = MulMod64(base, base, mod);
+	}
+	return result;
+}
+
+// Deterministic Miller-Rabin: the first twelve primes as witnesses are exact for
+// every n < 2^64 (Sorenson and Webster, 2015).
+static bool IsPrime64(uint64_t n) {
+	static const uint64_t WITNESSES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	if (n < 2) {
+		return false;
+	}
+	for (size_t i = 0; i < sizeof(WITNESSES) / sizeof(WITNESSES[0]); i++) {
+		if (n % WITNESSES[i] == 0) {
+			return n == WITNESSES[i];
+		}
+	}
+	uint64_t oddPart = n - 1;
+	int twos = 0;
+	while ((oddPart & 1) == 0) {
+		oddPart >>= 1;
+		twos++;
+	}
+	for (size_t i = 0; i < sizeof(WITNESSES) / sizeof(WITNESSES[0]); i++) {
+		uint64_t x = ExpMod64(WITNESSES[i], oddPart, n);
+		if (x == 1 || x == n - 1) {
+			continue;
+		}
+		bool composite = true;
+		for (int r = 1; r < twos && composite; r++) {
+			x = MulMod64(x, x, n);
+			composite = (x != n - 1);
+		}
+		if (composite) {
+			return false;
+		}
+	}
+	return true;
+}
 
 // Default ctor for the BigInteger class.
 BigInteger::BigInteger() :m_negative(false) {
@@ -13,16 +120,17 @@ BigInteger::BigInteger(string hex) : m_negative(false)
 {
 	// Convert the hex to binary
 	m_bits = HexToBinary(hex);
+	Resize();
 }
 
-BigInteger::BigInteger(int num) :m_negative(false) {
-	// Convert integer to hex string
-	std::stringstream stream;
-	stream << std::hex << num;
-	std::string hex(stream.str());
+// Compile-time constant, e.g. 0x101_big. Lands straight in the inline limbs.
+BigInteger::BigInteger(const BigLiteral & literal) :m_negative(false) {
+	SetWord(literal.Value(), false);
+}
 
-	// Convert hex to binary
-	m_bits = HexToBinary(hex);
+BigInteger::BigInteger(int num) :m_negative(num < 0) {
+	// Magnitude fits in a single limb -- negate in unsigned space so INT_MIN is safe
+	m_bits.push_back(num < 0 ? 0u - (uint32_t)num : (uint32_t)num);
 }
 
 // Overloaded operator= method to properly assign values in objects. 
@@ -35,41 +143,263 @@ BigInteger & BigInteger::operator=(const BigInteger & rhs) {
 }
 
 // Copy constructor for the BigInteger class. 
-BigInteger::BigInteger(const BigInteger & rhs) {
-	this->m_bits = rhs.m_bits;
-	this->m_negative = rhs.m_negative;
+BigInteger::BigInteger(const BigInteger & rhs) : m_bits(rhs.m_bits), m_negative(rhs.m_negative) {
 }
 
 // Converts hex input into a dynamically sized binary number.
-// 8 hexadecimal characters that will be converted into a binary notation.
-vector<uint32_t> BigInteger::HexToBinary(string strHex) {
-	vector<uint32_t> bits;
-	try {
-		if (strHex[0] == '-') {
-			strHex = strHex.substr(1, strHex.length() - 1);
-			m_negative = true;
-		}
-		// Reverse to force LSBs to be converted first
-		reverse(strHex.begin(), strHex.end());
-		for (int i = 0; i < ceil(strHex.length()) / 8; i++) {
-			// Take 8hex (32bit) and re-reverse
-			string sub = strHex.substr(i * 8, 8);
-			reverse(sub.begin(), sub.end());
-			if (sub.length() != 0)
-			{
-				// Convert substring into unsigned long from hex
-				uint32_t binary = std::stoul(sub, 0, 16);
-				bits.push_back(binary);
+// Digits are read from the LSB end straight into a preallocated limb vector,
+// 8 hexadecimal characters per 32-bit limb. An optional 0x prefix is accepted.
+LimbVector BigInteger::HexToBinary(const string & strHex) {
+	size_t begin = 0;
+	size_t end = strHex.length();
+	if (begin < end && strHex[begin] == '-') {
+		begin++;
+		m_negative = true;
+	}
+	if (end - begin >= 2 && strHex[begin] == '0' && (strHex[begin + 1] == 'x' || strHex[begin + 1] == 'X')) {
+		begin += 2;
+	}
+	size_t digits = end - begin;
+	LimbVector bits((digits + 7) / 8, 0);
+	for (size_t i = 0; i < digits; i++) {
+		int8_t value = HEX_VALUES[(unsigned char)strHex[end - 1 - i]];
+		if (value < 0) {
+			throw exception("Improper hex format.");
+		}
+		bits[i / 8] |= (uint32_t)value << (4 * (i % 8));
+	}
+	return bits;
+}
+
+// Parses a base 10 string, optionally starting with '-'. Large inputs are split on
+// the same 10^(9 * 2^k) table ToDecimal uses and recombined as high * 10^k + low, so
+// the work lands in a few balanced multiplications instead of one per 9 digits.
+BigInteger BigInteger::FromDecimal(const string & dec) {
+	size_t begin = (!dec.empty() && dec[0] == '-') ? 1 : 0;
+	if (begin == dec.length()) {
+		throw exception("Improper decimal format.");
+	}
+	for (size_t i = begin; i < dec.length(); i++) {
+		if (dec[i] < '0' || dec[i] > '9') {
+			throw exception("Improper decimal format.");
+		}
+	}
+	size_t len = dec.length() - begin;
+
+	// 10^9, 10^18, 10^36, ... while the low part of a split is shorter than the input
+	vector<BigInteger> powers;
+	BigInteger power(DECIMAL_LIMB);
+	if (len > DECIMAL_PARSE_SPLIT_DIGITS) {
+		while ((DECIMAL_LIMB_DIGITS << powers.size()) < len) {
+			powers.push_back(power);
+			if ((DECIMAL_LIMB_DIGITS << powers.size()) < len) {
+				power *= power;
 			}
 		}
 	}
-	catch (...) {
-		bits.clear();
-		throw exception("Improper hex format.");
+	BigInteger result;
+	result.m_bits = DecimalToBinary(dec.data() + begin, len, powers, powers.size());
+	result.m_negative = (begin == 1);
+	result.Resize();
+	return result;
+}
+
+// Returns the value in base 10. The magnitude is split by the largest cached
+// 10^(9 * 2^k) below it and each half is converted independently. Splits with a
+// long quotient divide by multiplying with a Newton reciprocal, so large values cost
+// a few big multiplications per level instead of a long division.
+string BigInteger::ToDecimal() const {
+	string result;
+	if (this->m_negative) {
+		result = "-";
+	}
+	BigInteger magnitude = this->Abs();
+	magnitude.Resize();
+
+	// 10^9, 10^18, 10^36, ... while the square of the last one still fits below the
+	// value, so every split leaves a quotient smaller than its divisor
+	vector<BigInteger> powers, reciprocals;
+	BigInteger power(DECIMAL_LIMB);
+	if (magnitude.m_bits.size() * DECIMAL_LIMB_DIGITS > DECIMAL_SPLIT_DIGITS) {
+		while (power.m_bits.size() * 2 <= magnitude.m_bits.size() + 1) {
+			BigInteger square = power * power;
+			if (square > magnitude) {
+				break;
+			}
+			powers.push_back(power);
+			power = square;
+		}
+		powers.push_back(power);
+		reciprocals.resize(powers.size(), ZERO);
+	}
+	string digits;
+	BinaryToDecimal(magnitude, powers, reciprocals, powers.size(), 0, digits);
+	result += digits;
+	return result;
+}
+
+// Raw little-endian limbs, least significant first. The sign is not included.
+const LimbVector & BigInteger::Limbs() const {
+	return m_bits;
+}
+
+// Builds a non-negative BigInteger from little-endian limbs, e.g. a mapped file.
+BigInteger BigInteger::FromLimbs(const uint32_t * limbs, size_t count) {
+	BigInteger result;
+	result.m_bits.assign(limbs, limbs + count);
+	if (result.m_bits.empty()) {
+		result.m_bits.push_back(0);
+	}
+	result.Resize();
+	return result;
+}
+
+// Parses len decimal digits into limbs. powers[k] is 10^(9 * 2^k); the last
+// 9 * 2^(level - 1) digits are converted separately and added to high * powers[level - 1].
+LimbVector BigInteger::DecimalToBinary(const char * dec, size_t len, const vector<BigInteger> & powers,
+	size_t level) {
+	if (level > 0 && len > DECIMAL_PARSE_SPLIT_DIGITS) {
+		size_t lowLen = DECIMAL_LIMB_DIGITS << (level - 1);
+		if (len <= lowLen) {
+			return DecimalToBinary(dec, len, powers, level - 1);
+		}
+		BigInteger high;
+		high.m_bits = DecimalToBinary(dec, len - lowLen, powers, level - 1);
+		BigInteger low;
+		low.m_bits = DecimalToBinary(dec + len - lowLen, lowLen, powers, level - 1);
+		high.Resize();
+		low.Resize();
+		high *= powers[level - 1];
+		high += low;
+		return high.m_bits;
+	}
+	// Consume 9 digits at a time: bits = bits * 10^k + chunk
+	LimbVector bits(1, 0);
+	size_t pos = 0;
+	while (pos < len) {
+		size_t take = std::min(DECIMAL_LIMB_DIGITS, len - pos);
+		uint32_t chunk = 0;
+		uint32_t scale = 1;
+		for (size_t k = 0; k < take; k++) {
+			chunk = chunk * 10 + (uint32_t)(dec[pos + k] - '0');
+			scale *= 10;
+		}
+		pos += take;
+		uint64_t carry = chunk;
+		for (size_t i = 0; i < bits.size(); i++) {
+			uint64_t cur = (uint64_t)bits[i] * scale + carry;
+			bits[i] = (uint32_t)cur;
+			carry = cur >> 32;
+		}
+		if (carry) {
+			bits.push_back((uint32_t)carry);
+		}
 	}
 	return bits;
 }
 
+// Appends the digits of num to out. powers[k] is 10^(9 * 2^k) and reciprocals[k]
+// caches its Reciprocal once a split needs it (zero until then); num must be below
+// powers[level - 1] squared. When width is non-zero the output is left padded with
+// zeros to exactly width digits.
+void BigInteger::BinaryToDecimal(const BigInteger & num, const vector<BigInteger> & powers,
+	vector<BigInteger> & reciprocals, size_t level, size_t width, string & out) {
+	if (level > 0 && num.m_bits.size() * DECIMAL_LIMB_DIGITS > DECIMAL_SPLIT_DIGITS) {
+		const BigInteger & split = powers[level - 1];
+		size_t lowWidth = DECIMAL_LIMB_DIGITS << (level - 1);
+		BigInteger high, low;
+		// Long division costs quotient limbs times divisor limbs, so a short quotient
+		// stays cheaper than two multiplications
+		if (num.m_bits.size() >= split.m_bits.size() + DECIMAL_RECIP_MIN_LIMBS) {
+			BigInteger & reciprocal = reciprocals[level - 1];
+			if (reciprocal == ZERO) {
+				reciprocal = Reciprocal(split);
+			}
+			// Barrett: the reciprocal is within a few units, so is the quotient estimate
+			int bits = (int)split.BitLength();
+			high = ((num >> BigInteger(bits - 1)) * reciprocal) >> BigInteger(bits + 1);
+			low = num - high * split;
+			while (low < ZERO) {
+				high -= ONE;
+				low += split;
+			}
+			while (low >= split) {
+				++high;
+				low -= split;
+			}
+		}
+		else {
+			LimbVector quotient, remainder;
+			DivModMagnitude(num.m_bits, split.m_bits, quotient, remainder);
+			high.m_bits = quotient;
+			low.m_bits = remainder;
+			high.Resize();
+			low.Resize();
+		}
+		// Leading zeros are only dropped for the most significant part
+		if (width == 0 && high == ZERO) {
+			BinaryToDecimal(low, powers, reciprocals, level - 1, 0, out);
+		}
+		else {
+			BinaryToDecimal(high, powers, reciprocals, level - 1, width ? width - lowWidth : 0, out);
+			BinaryToDecimal(low, powers, reciprocals, level - 1, lowWidth, out);
+		}
+		return;
+	}
+	// Peel off 9 digits at a time with short division by 10^9
+	LimbVector bits = num.m_bits;
+	string digits;
+	size_t size = bits.size();
+	while (size > 0 && bits[size - 1] == 0) {
+		size--;
+	}
+	while (size > 0) {
+		uint64_t rem = 0;
+		for (size_t i = size; i-- > 0;) {
+			uint64_t cur = (rem << 32) | bits[i];
+			bits[i] = (uint32_t)(cur / DECIMAL_LIMB);
+			rem = cur % DECIMAL_LIMB;
+		}
+		while (size > 0 && bits[size - 1] == 0) {
+			size--;
+		}
+		for (size_t k = 0; k < DECIMAL_LIMB_DIGITS; k++) {
+			digits.push_back((char)('0' + rem % 10));
+			rem /= 10;
+		}
+	}
+	while (digits.size() > 1 && digits.back() == '0') {
+		digits.pop_back();
+	}
+	if (digits.empty()) {
+		digits = "0";
+	}
+	if (width > digits.size()) {
+		out.append(width - digits.size(), '0');
+	}
+	out.append(digits.rbegin(), digits.rend());
+}
+
+// About 2^(2 * b) / den for a den of b bits, within a few units. The top half of
+// den is inverted recursively and refined with one Newton step,
+// x' = x + x * (2^(2b) - den * x) / 2^(2b), which doubles the correct bits. The
+// correction only needs half the bits of each factor, so every level costs well
+// under one full-size multiplication.
+BigInteger BigInteger::Reciprocal(const BigInteger & den) {
+	int bits = (int)den.BitLength();
+	if (den.m_bits.size() <= DECIMAL_RECIP_BASE_LIMBS) {
+		return (ONE << BigInteger(2 * bits)) / den;
+	}
+	// x = top * 2^shift; error and correction are kept in units of 2^shift with 32
+	// guard bits, where the dropped low bits of error are worth under 2^-32
+	int topBits = bits / 2 + 32;
+	int shift = bits - topBits;
+	BigInteger top = Reciprocal(den >> BigInteger(shift));
+	BigInteger error = (ONE << BigInteger(2 * bits - shift)) - den * top;
+	BigInteger correction = (top * (error >> BigInteger(topBits - 32))) >> BigInteger(topBits + 32);
+	return (top << BigInteger(shift)) + correction;
+}
+
 // Overrides the + operator in order to add  one BigInteger to another. 
 BigInteger BigInteger::operator+(const BigInteger & rhs) const {
 	BigInteger ret = *this;
@@ -79,45 +409,44 @@ BigInteger BigInteger::operator+(const BigInteger & rhs) const {
 // Overrides the += operator in order to add and simultaneously
 // assign one BigInteger to another. 
 BigInteger & BigInteger::operator+=(const BigInteger & rhs) {
-	int carry = 0;
-	BigInteger longerNum;
-	BigInteger shorterNum;
-
-	if (rhs.m_bits.size() > this->m_bits.size()) {
-		longerNum = rhs;
-		shorterNum = *this;
+	if (IsWord() && rhs.IsWord() && AddWord(rhs.WordValue(), rhs.m_negative)) {
+		return *this;
+	}
+	// Same signs add magnitudes and keep the sign
+	if (this->m_negative == rhs.m_negative) {
+		AddMagnitude(this->m_bits, rhs.m_bits);
+	}
+	// Otherwise subtract the smaller magnitude from the larger one
+	else if (CompareMagnitude(this->m_bits, rhs.m_bits) >= 0) {
+		SubMagnitude(this->m_bits, rhs.m_bits);
 	}
 	else {
-		longerNum = *this;
-		shorterNum = rhs;
+		LimbVector larger = rhs.m_bits;
+		SubMagnitude(larger, this->m_bits);
+		this->m_bits = std::move(larger);
+		this->m_negative = rhs.m_negative;
 	}
-	// First iterate over shorter number, then the remaining elements
-	for (int i = 0; i < shorterNum.m_bits.size(); i++) {
-		uint64_t sum = (uint64_t)longerNum.m_bits[i] + (uint64_t)shorterNum.m_bits[i] + carry;
-		// Check carry and overflow
-		carry = 0;
-		if (sum >= UINT32_MAX) {
-			carry = 1;
-			sum -= (UINT32_MAX + 1);
+	Resize();
+	return *this;
+}
+
+// Native signed add of a word-sized value onto a word-sized this. Returns false,
+// leaving this untouched, when the sum overflows 64 bits.
+bool BigInteger::AddWord(uint64_t value, bool negative) {
+	uint64_t current = WordValue();
+	if (m_negative == negative) {
+		if (current + value < current) {
+			return false;
 		}
-		// Put the "remainder" value in the current element
-		longerNum.m_bits[i] = sum;
+		SetWord(current + value, negative);
 	}
-	for (int i = shorterNum.m_bits.size(); i < longerNum.m_bits.size(); i++) {
-		longerNum.m_bits[i] += carry;
-		carry = 0;
-		if (longerNum.m_bits[i] > UINT32_MAX) {
-			carry = 1;
-			longerNum.m_bits[i] -= (UINT32_MAX + 1);
-		}
+	else if (current >= value) {
+		SetWord(current - value, m_negative);
 	}
-	// Check carry once more -- push 1 at MSB
-	if (carry) {
-		longerNum.m_bits.push_back(1);
-		carry = 0;
+	else {
+		SetWord(value - current, negative);
 	}
-	*this = longerNum;
-	return *this;
+	return true;
 }
 
 // Overrides the - operator in order to subtract one BigInteger
@@ -131,87 +460,13 @@ BigInteger BigInteger::operator-(const BigInteger & rhs) const
 // Overrides the -= operator in order to subtract and simultaneously
 // assign one BigInteger to another. 
 BigInteger & BigInteger::operator-=(const BigInteger & rhs)  {
-	int borrow = 0; 
-	uint32_t diff = 0;
-	BigInteger finalNum;
-	BigInteger largerNum;
-	BigInteger smallerNum;
-
-	if (*this == rhs) {
-		*this = ZERO;
+	if (IsWord() && rhs.IsWord() && AddWord(rhs.WordValue(), !rhs.m_negative)) {
 		return *this;
 	}
-	//Determine the larger value
-	if (*this > rhs) {
-		largerNum = *this;
-		smallerNum = rhs;
-	}
-	else{
-		largerNum = rhs;
-		smallerNum = *this;
-	}
-	// Check if the signs are not equal
-	if (this->m_negative != rhs.m_negative) {
-		finalNum = (largerNum.Abs() + smallerNum.Abs());
-		if (this->m_negative) {
-			finalNum.m_negative = true;
-		}
-	}
-	else {
-		// Equivalent numbers = 0
-		if (*this == rhs) {
-			finalNum = BigInteger("0");
-		}
-		// Make both numbers positive
-		BigInteger l = largerNum.Abs();
-		BigInteger s = smallerNum.Abs();
-
-		// Iterate over the smaller number and then the larger number
-		for (int i = 0; i < s.m_bits.size(); i++) {
-			diff = (int32_t)l.m_bits[i] - (int32_t)s.m_bits[i] - borrow;
-			// Check borrow and underflow
-			if (borrow) {
-				borrow = 0;
-			}
-			if (diff < 0) {
-				diff += UINT32_MAX;
-				borrow = 1;
-			}
-			l.m_bits[i] = diff;
-		}
-		for (int i = s.m_bits.size(); i < l.m_bits.size(); i++) {
-			if (borrow) {
-				diff = l.m_bits[i] - 1;
-				borrow = 0;
-			}
-			if (diff < 0) {
-				l.m_bits[i] = Mod(diff, UINT32_MAX);
-				borrow = 1;
-			}
-		}
-		// Final value is determined by original signs (+/-)
-		if (this->m_negative) {
-			if (*this > rhs) {
-				l.m_negative = true;
-			}
-			else {
-				l.m_negative = false;
-			}
-		}
-		else {
-			if (*this > rhs) {
-				l.m_negative = false;
-			}
-			else {
-				l.m_negative = true;
-			}
-		}
-		finalNum = l;
-	}
-	// In case it requires less bits than before
-	finalNum.Resize();
-	*this = finalNum;
-	return *this;
+	// a - b == a + (-b)
+	BigInteger negated = rhs;
+	negated.m_negative = !rhs.m_negative;
+	return *this += negated;
 }
 
 // Overrides the *= operator to multiply two BigIntegers
@@ -224,49 +479,43 @@ BigInteger BigInteger::operator*(const BigInteger & rhs) const {
 // One BigInteger to another. 
 BigInteger & BigInteger::operator*=(const BigInteger & rhs)
 {
-	BigInteger longerNum;
-	BigInteger shorterNum;
-	BigInteger product;
-	int carry = 0;
-
+	if (IsWord() && rhs.IsWord()) {
+		uint64_t low;
+		if (MulWide(WordValue(), rhs.WordValue(), low) == 0) {
+			return SetWord(low, this->m_negative != rhs.m_negative);
+		}
+	}
 	if (rhs == ZERO || *this == ZERO) {
 		*this = ZERO;
 		return *this;
 	}
-	// Find the longer of two numbers
-	if (rhs.m_bits.size() > this->m_bits.size()) {
-		longerNum = rhs;
-		shorterNum = *this;
+	LimbVector product(this->m_bits.size() + rhs.m_bits.size(), 0);
+	size_t shorter = std::min(this->m_bits.size(), rhs.m_bits.size());
+	// Equal operands go through the NTT as a square, transforming only once
+	bool square = shorter >= NTT_MIN_SQUARE_LIMBS && EqualMagnitude(this->m_bits, rhs.m_bits);
+	if (square || shorter >= NTT_MIN_LIMBS) {
+		const LimbVector & other = square ? this->m_bits : rhs.m_bits;
+		Ntt::Multiply(this->m_bits.data(), this->m_bits.size(), other.data(), other.size(), product.data());
+		this->m_negative = (this->m_negative != rhs.m_negative);
+		this->m_bits = std::move(product);
+		Resize();
+		return *this;
 	}
-	else {
-		longerNum = *this;
-		shorterNum = rhs;
-	}
-	// Multiply single value of smaller # by each value of the larger #
-	uint64_t prod = 0;
-	for (int i = 0; i < shorterNum.m_bits.size(); i++) {
-		for (int j = 0; j < longerNum.m_bits.size(); j++) {
-			prod = (uint64_t)shorterNum.m_bits[i] * (uint64_t)longerNum.m_bits[j];
-			// Check carry and overflow
-			prod += carry;
-			carry = 0;
-			if (prod > UINT32_MAX) {
-				carry = prod / ((uint64_t)UINT32_MAX + 1);
-				prod -= carry * ((uint64_t)UINT32_MAX + 1);
-			}
-			// Push final product into final array
-			product.m_bits.push_back(prod);
+	// Schoolbook multiplication: every limb of rhs against every limb of this,
+	// accumulated into the column i + j of the product
+	for (size_t i = 0; i < rhs.m_bits.size(); i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < this->m_bits.size(); j++) {
+			uint64_t prod = (uint64_t)rhs.m_bits[i] * (uint64_t)this->m_bits[j] + product[i + j] + carry;
+			product[i + j] = (uint32_t)prod;
+			carry = prod >> 32;
 		}
-		prod = 0;
-	}
-	if (carry > 0) {
-		product.m_bits.push_back(carry);	// bring down the remaining carry value
+		product[i + this->m_bits.size()] = (uint32_t)carry;
 	}
 	// Final value relies on initial sign
-	if (this->m_negative != rhs.m_negative) {
-		product.m_negative = true;
-	}
-	*this = product;
+	this->m_negative = (this->m_negative != rhs.m_negative);
+	this->m_bits = std::move(product);
+	Resize();
 	return *this;
 }
 
@@ -281,49 +530,31 @@ BigInteger & BigInteger::operator/=(const BigInteger & rhs) {
 	if (rhs == ZERO) {
 		throw new exception("ERROR: Cannot divide by 0");
 	}
-
-	BigInteger righths = rhs;
-	BigInteger remainder = ZERO;
-	BigInteger quotient = *this;
-	// Quotient could be same size as original numerator -- clear out with 0s, preserve size
-	for (int i = 0; i < this->m_bits.size(); i++) {
-		quotient.m_bits[i] = 0;
-	}
-	for (int i = this->BitLength() - 1; i >= 0; i -= 1) {
-		remainder <<= 1;
-		remainder.SetBit(0, this->GetBit(i));
-		// .Abs() Is used to "pretend" we're still working with positive numbers
-		if (remainder.Abs() >= righths.Abs()) {
-			remainder -= righths.Abs();
-			// WAS just i
-			quotient.SetBit(i, true);
-		}
+	if (IsWord() && rhs.IsWord()) {
+		return SetWord(WordValue() / rhs.WordValue(), this->m_negative != rhs.m_negative);
 	}
+	LimbVector quotient, remainder;
+	DivModMagnitude(this->m_bits, rhs.m_bits, quotient, remainder);
 	// Final value relies on initial sign
-	if (this->m_negative != righths.m_negative) {
-		quotient.m_negative = true;
-	}
-	quotient.Resize();
-	*this = quotient;
+	this->m_negative = (this->m_negative != rhs.m_negative);
+	this->m_bits = std::move(quotient);
+	Resize();
 	return *this;
 }
 
-BigInteger BigInteger::Abs(){
+BigInteger BigInteger::Abs() const {
 	BigInteger ret = *this;
 	ret.m_negative = false;
 	return ret;
 }
 
-BigInteger BigInteger::InvertBits() {
+BigInteger BigInteger::InvertBits() const {
 	BigInteger ret = *this;
-	for (int i = 0; i < m_bits.size(); i++) {
-		ret.m_bits[i] = ~ret.m_bits[i];
-	}
+	GetLimbKernels().invert(ret.m_bits.data(), ret.m_bits.size());
 	return ret;
 }
 
 BigInteger BigInteger::Pow(BigInteger base, BigInteger exp) {
-	BigInteger TWO(2);
 	if (exp == ZERO) {
 		return ONE;
 	}
@@ -340,10 +571,17 @@ BigInteger BigInteger::operator%(const BigInteger & rhs) const {
 }
 
 BigInteger & BigInteger::operator%=(const BigInteger & rhs) {
-	// Find the first value that is less than the divisor
-	while (*this >= rhs) {
-		*this -= rhs;
+	if (rhs == ZERO) {
+		throw new exception("ERROR: Cannot divide by 0");
 	}
+	// Remainder takes the sign of the dividend, as with the built-in %
+	if (IsWord() && rhs.IsWord()) {
+		return SetWord(WordValue() % rhs.WordValue(), this->m_negative);
+	}
+	LimbVector quotient, remainder;
+	DivModMagnitude(this->m_bits, rhs.m_bits, quotient, remainder);
+	this->m_bits = std::move(remainder);
+	Resize();
 	// Returning the remainder
 	return *this;
 
@@ -354,71 +592,239 @@ uint32_t BigInteger::Mod(int32_t a, int32_t b) {
 }
 
 BigInteger & BigInteger::Resize() {
-	vector<uint32_t>::iterator it = m_bits.end();
 	// Iterate from end to beginning of the vector -- compare against uint0
-	for (int i = m_bits.size() - 1; i > 0 && m_bits[i] == 0; i--) {
+	while (m_bits.size() > 1 && m_bits.back() == 0) {
 		m_bits.pop_back();
 	}
+	// There is no negative zero
+	if (m_bits.empty() || (m_bits.size() == 1 && m_bits[0] == 0)) {
+		m_negative = false;
+	}
 	return *this;
 }
 
-// Compares whether one BigInteger is greater than to another. 
-bool BigInteger::operator>(const BigInteger & rhs) const {
-	bool gt = false;
-	// If they aren't the same sign, positive is obviously greater.
-	if (this->m_negative != rhs.m_negative) {
-		if (this->m_negative) {
-			return false;
+// True when the magnitude fits in one 64-bit machine word and so stays in the
+// inline limb storage; such values take the native arithmetic paths below.
+bool BigInteger::IsWord() const {
+	return m_bits.size() <= 2;
+}
+
+uint64_t BigInteger::WordValue() const {
+	if (m_bits.empty()) {
+		return 0;
+	}
+	return m_bits.size() == 1 ? m_bits[0] : ((uint64_t)m_bits[1] << 32) | m_bits[0];
+}
+
+BigInteger & BigInteger::SetWord(uint64_t value, bool negative) {
+	m_bits.AssignWord(value);
+	m_negative = negative && value != 0;
+	return *this;
+}
+
+// Compares the magnitudes of two limb vectors, ignoring leading zero limbs.
+// Returns -1, 0 or 1 like strcmp.
+int BigInteger::CompareMagnitude(const LimbVector & lhs, const LimbVector & rhs) {
+	size_t lhsSize = lhs.size();
+	size_t rhsSize = rhs.size();
+	while (lhsSize > 0 && lhs[lhsSize - 1] == 0) {
+		lhsSize--;
+	}
+	while (rhsSize > 0 && rhs[rhsSize - 1] == 0) {
+		rhsSize--;
+	}
+	if (lhsSize != rhsSize) {
+		return lhsSize > rhsSize ? 1 : -1;
+	}
+	// if the sizes are equal, compare elements starting from MSB
+	return GetLimbKernels().compare(lhs.data(), rhs.data(), lhsSize);
+}
+
+// Equality of magnitudes, ignoring leading zero limbs.
+bool BigInteger::EqualMagnitude(const LimbVector & lhs, const LimbVector & rhs) {
+	size_t lhsSize = lhs.size();
+	size_t rhsSize = rhs.size();
+	while (lhsSize > 0 && lhs[lhsSize - 1] == 0) {
+		lhsSize--;
+	}
+	while (rhsSize > 0 && rhs[rhsSize - 1] == 0) {
+		rhsSize--;
+	}
+	return lhsSize == rhsSize && GetLimbKernels().equal(lhs.data(), rhs.data(), lhsSize);
+}
+
+// Adds the magnitude of rhs into lhs, growing lhs as needed.
+void BigInteger::AddMagnitude(LimbVector & lhs, const LimbVector & rhs) {
+	if (lhs.size() < rhs.size()) {
+		lhs.resize(rhs.size(), 0);
+	}
+	uint64_t carry = 0;
+	size_t i = 0;
+	// First iterate over the shorter number, then propagate the carry
+	for (; i < rhs.size(); i++) {
+		uint64_t sum = (uint64_t)lhs[i] + (uint64_t)rhs[i] + carry;
+		lhs[i] = (uint32_t)sum;
+		carry = sum >> 32;
+	}
+	for (; carry && i < lhs.size(); i++) {
+		uint64_t sum = (uint64_t)lhs[i] + carry;
+		lhs[i] = (uint32_t)sum;
+		carry = sum >> 32;
+	}
+	// Check carry once more -- push 1 at MSB
+	if (carry) {
+		lhs.push_back(1);
+	}
+}
+
+// Subtracts the magnitude of rhs from lhs. The caller guarantees |lhs| >= |rhs|.
+void BigInteger::SubMagnitude(LimbVector & lhs, const LimbVector & rhs) {
+	uint64_t borrow = 0;
+	size_t i = 0;
+	for (; i < rhs.size() && i < lhs.size(); i++) {
+		uint64_t diff = (uint64_t)lhs[i] - (uint64_t)rhs[i] - borrow;
+		lhs[i] = (uint32_t)diff;
+		// Wrapped around means we borrowed from the next limb
+		borrow = (diff >> 63) & 1;
+	}
+	for (; borrow && i < lhs.size(); i++) {
+		uint64_t diff = (uint64_t)lhs[i] - borrow;
+		lhs[i] = (uint32_t)diff;
+		borrow = (diff >> 63) & 1;
+	}
+}
+
+// Long division of magnitudes (Knuth, TAOCP vol. 2, 4.3.1 algorithm D).
+// The divisor must be non-zero.
+void BigInteger::DivModMagnitude(const LimbVector & num, const LimbVector & den,
+	LimbVector & quotient, LimbVector & remainder) {
+	size_t n = den.size();
+	while (n > 0 && den[n - 1] == 0) {
+		n--;
+	}
+	size_t m = num.size();
+	while (m > 0 && num[m - 1] == 0) {
+		m--;
+	}
+	if (m < n || CompareMagnitude(num, den) < 0) {
+		quotient.assign(1, 0);
+		remainder.assign(num.begin(), num.begin() + (m ? m : 0));
+		if (remainder.empty()) {
+			remainder.push_back(0);
 		}
-		else {
-			return true;
+		return;
+	}
+	quotient.assign(m - n + 1, 0);
+
+	// Single limb divisor -- simple short division
+	if (n == 1) {
+		uint64_t rem = 0;
+		for (size_t i = m; i-- > 0;) {
+			uint64_t cur = (rem << 32) | num[i];
+			quotient[i] = (uint32_t)(cur / den[0]);
+			rem = cur % den[0];
 		}
+		remainder.assign(1, (uint32_t)rem);
+		return;
 	}
-	else {
-		// Check the vector size 
-		if (this->m_bits.size() > rhs.m_bits.size()) {
-			return true;
+
+	// Normalize so the top limb of the divisor has its high bit set
+	int shift = 0;
+	for (uint32_t top = den[n - 1]; !(top & 0x80000000u); top <<= 1) {
+		shift++;
+	}
+	vector<uint32_t> v(n), u(m + 1);
+	for (size_t i = n - 1; i > 0; i--) {
+		v[i] = (den[i] << shift) | (shift ? (uint32_t)((uint64_t)den[i - 1] >> (32 - shift)) : 0);
+	}
+	v[0] = den[0] << shift;
+	u[m] = shift ? (uint32_t)((uint64_t)num[m - 1] >> (32 - shift)) : 0;
+	for (size_t i = m - 1; i > 0; i--) {
+		u[i] = (num[i] << shift) | (shift ? (uint32_t)((uint64_t)num[i - 1] >> (32 - shift)) : 0);
+	}
+	u[0] = num[0] << shift;
+
+	const uint64_t base = (uint64_t)1 << 32;
+	for (size_t j = m - n + 1; j-- > 0;) {
+		// Estimate the quotient digit from the top two limbs
+		uint64_t top = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+		uint64_t qhat = top / v[n - 1];
+		uint64_t rhat = top % v[n - 1];
+		while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+			qhat--;
+			rhat += v[n - 1];
+			if (rhat >= base) {
+				break;
+			}
 		}
-		else if (this->m_bits.size() < rhs.m_bits.size()) {
-			return false;
+		// Multiply and subtract
+		int64_t borrow = 0;
+		uint64_t carry = 0;
+		for (size_t i = 0; i < n; i++) {
+			uint64_t p = qhat * v[i] + carry;
+			carry = p >> 32;
+			int64_t t = (int64_t)u[i + j] - borrow - (int64_t)(p & 0xFFFFFFFFu);
+			u[i + j] = (uint32_t)t;
+			borrow = t < 0 ? 1 : 0;
 		}
-		else {
-			// if the sizes are equal, iterate over each element starting from MSB
-			for (int i = this->m_bits.size()-1; i >=0; i--) {
-				// Only check if numbers are unequal
-				if (this->m_bits[i] != rhs.m_bits[i]) {
-					// Compare values
-					if (this->m_bits[i] > rhs.m_bits[i]) {
-						return true;
-					}
-					else {
-						return false;
-					}
-				}
+		int64_t t = (int64_t)u[j + n] - borrow - (int64_t)carry;
+		u[j + n] = (uint32_t)t;
+		// Estimate was one too large -- add the divisor back
+		if (t < 0) {
+			qhat--;
+			uint64_t c = 0;
+			for (size_t i = 0; i < n; i++) {
+				uint64_t s = (uint64_t)u[i + j] + v[i] + c;
+				u[i + j] = (uint32_t)s;
+				c = s >> 32;
 			}
+			u[j + n] += (uint32_t)c;
 		}
+		quotient[j] = (uint32_t)qhat;
+	}
+	// Denormalize the remainder
+	remainder.assign(n, 0);
+	for (size_t i = 0; i < n; i++) {
+		remainder[i] = (u[i] >> shift) | (shift ? (uint32_t)((uint64_t)u[i + 1] << (32 - shift)) : 0);
 	}
-	return gt;
+}
+
+// Compares whether one BigInteger is greater than to another. 
+bool BigInteger::operator>(const BigInteger & rhs) const {
+	// If they aren't the same sign, positive is obviously greater.
+	if (this->m_negative != rhs.m_negative) {
+		return !this->m_negative;
+	}
+	if (IsWord() && rhs.IsWord()) {
+		return this->m_negative ? WordValue() < rhs.WordValue() : WordValue() > rhs.WordValue();
+	}
+	int cmp = CompareMagnitude(this->m_bits, rhs.m_bits);
+	// Larger magnitude is smaller when both are negative
+	return this->m_negative ? cmp < 0 : cmp > 0;
 }
 
 // Compares whether one BigInteger is greater than/equal to another. 
 bool BigInteger::operator>=(const BigInteger & rhs)const {
-	return ((*this > rhs) || (*this == rhs));
+	// One comparison instead of > followed by ==
+	return !(rhs > *this);
 }
 
 // Compares whether one BigInteger is equal to another. 
 bool BigInteger::operator==(const BigInteger & rhs) const {
-	return ((this->m_negative == rhs.m_negative) && (this->m_bits == rhs.m_bits));
+	if (IsWord() && rhs.IsWord()) {
+		return this->m_negative == rhs.m_negative && WordValue() == rhs.WordValue();
+	}
+	return ((this->m_negative == rhs.m_negative) && EqualMagnitude(this->m_bits, rhs.m_bits));
 }
 
 // Compares whether one BigInteger is NOT equal to another. 
 bool BigInteger::operator!=(const BigInteger & rhs) const {
-	return !((this->m_negative == rhs.m_negative) && (this->m_bits == rhs.m_bits));
+	return !(*this == rhs);
 }
 
 // Compares whether one BigInteger is less than another. 
 bool BigInteger::operator<(const BigInteger & rhs)const {
-	return !(*this >= rhs);
+	return rhs > *this;
 }
 
 // Compares whether one BigInteger is less than/equal to another. 
@@ -427,32 +833,39 @@ bool BigInteger::operator<=(const BigInteger & rhs)const {
 }
 
 // Function designed to interpret a BigInteger and return it as a String. 
-string BigInteger::ToString() {
-	std::stringstream stream;
-	string result = "0x";
-
-	if (this->m_negative) {
-		result = "-0x";
+// Nibbles are written straight into a preallocated buffer, MSB first.
+string BigInteger::ToString() const {
+	size_t size = this->m_bits.size();
+	while (size > 1 && this->m_bits[size - 1] == 0) {
+		size--;
 	}
-	// Iterate over bits, MSB -> LSB
-	for (int i = this->m_bits.size() - 1; i >=0; i--) {
-		stream.fill('0');
-		stream.width(8);
-		stream << hex << this->m_bits[i];
+	string result(size * 8, '0');
+	for (size_t i = 0; i < size; i++) {
+		uint32_t limb = this->m_bits[i];
+		size_t pos = result.length() - 1 - i * 8;
+		for (int k = 0; k < 8; k++) {
+			result[pos - k] = HEX_DIGITS[(limb >> (4 * k)) & 0xF];
+		}
 	}
-	result += stream.str();
-	result = result.erase(0, result.find_first_not_of('0'));
-	return result;
+	// Drop leading zeros, but keep one digit for zero itself
+	size_t first = result.find_first_not_of('0');
+	if (first == string::npos) {
+		result = "0";
+	}
+	else {
+		result.erase(0, first);
+	}
+	return (this->m_negative ? "-0x" : "0x") + result;
 }
 
 // Overrides the ostream operator to better output the values of
 // BigIntegers. 
-ostream & operator<<(ostream & os, BigInteger & num) {
+ostream & operator<<(ostream & os, const BigInteger & num) {
 	os << num.ToString();
 	return os;
 }
 
-uint32_t BigInteger::GetBit(uint32_t bitPos) {
+uint32_t BigInteger::GetBit(uint32_t bitPos) const {
 	if (bitPos >= this->m_bits.size() * 32) {
 		throw exception("Invalid bit position.");
 	}
@@ -481,23 +894,26 @@ BigInteger BigInteger::operator<<(const BigInteger & rhs) const {
 }
 
 BigInteger & BigInteger::operator<<=(const BigInteger & rhs) {
-	uint32_t prevMSB = 0;
-	uint32_t currMSB = 0;
-	// Do process for as many times as rhs
-	for (BigInteger i = ZERO; i < rhs; i++) {
-		for (int j = 0; j < m_bits.size(); j++) {
-			// Get value of bit 31
-			if ((m_bits[j] & (1 << 31)) == 1) {
-				currMSB = 1;
-			}
-			m_bits[j] <<= 1;
-			// Set 0th bit to be 1 or 0
-			m_bits[j] |= (prevMSB);
-			prevMSB = currMSB;
-			currMSB = 0;
+	if (m_bits.empty() || rhs <= ZERO) {
+		return *this;
+	}
+	uint32_t count = rhs.m_bits[0];
+	// Stays native as long as no set bit is shifted past bit 63
+	if (IsWord() && rhs.m_bits.size() == 1 && count < 64 && (WordValue() >> (64 - count)) == 0) {
+		return SetWord(WordValue() << count, m_negative);
+	}
+	// Shift whole limbs first, then the remaining bits
+	uint32_t limbShift = count / 32;
+	uint32_t bitShift = count % 32;
+	m_bits.insert(m_bits.begin(), limbShift, 0);
+	if (bitShift) {
+		// Bits carried out of the top limb become a new limb
+		uint32_t carry = GetLimbKernels().shiftLeft(m_bits.data() + limbShift, m_bits.size() - limbShift, bitShift);
+		if (carry) {
+			m_bits.push_back(carry);
 		}
 	}
-	return *this;
+	return Resize();
 }
 
 BigInteger BigInteger::operator>>(const BigInteger & shift) const {
@@ -506,33 +922,36 @@ BigInteger BigInteger::operator>>(const BigInteger & shift) const {
 }
 
 BigInteger & BigInteger::operator>>=(const BigInteger & rhs) {
-	//uint32_t prevLSB = 0;
-	//uint32_t currLSB = 0;
-	// Do process for as many times as rhs
-	for (BigInteger i = ZERO; i < rhs; i++) {
-		uint32_t prevLSB = 0;
-		uint32_t currLSB = 0;
-		for (int j = this->m_bits.size() - 1; j >= 0; j--) {
-			// Get value of bit 0
-			if ((this->m_bits[j] & 1) == 1) {
-				currLSB = 1;
-			}
-			// Shift the value
-			this->m_bits[j] >>= 1;
-			// Set 31st bit
-			this->m_bits[j] |= (prevLSB << 31);
-			// Retain the current LSB as now-previous LSB
-			prevLSB = currLSB;
-			currLSB = 0;
-		}
+	if (m_bits.empty() || rhs <= ZERO) {
+		return *this;
 	}
-	return *this;
+	uint32_t count = rhs.m_bits[0];
+	if (IsWord() && rhs.m_bits.size() == 1) {
+		return SetWord(count < 64 ? WordValue() >> count : 0, m_negative);
+	}
+	// Drop whole limbs first, then the remaining bits
+	uint32_t limbShift = count / 32;
+	uint32_t bitShift = count % 32;
+	if (rhs.m_bits.size() > 1 || limbShift >= m_bits.size()) {
+		*this = ZERO;
+		return *this;
+	}
+	m_bits.erase(m_bits.begin(), m_bits.begin() + limbShift);
+	if (bitShift) {
+		GetLimbKernels().shiftRight(m_bits.data(), m_bits.size(), bitShift);
+	}
+	return Resize();
 }
 
 // Emulates a ModPow function for this BigInteger class
 BigInteger BigInteger::ExpMod(BigInteger base, BigInteger exp, BigInteger mod) {
+	// Word-sized modulus: square-and-multiply on native words with a 128-bit product
+	if (mod.IsWord() && exp.IsWord() && !mod.m_negative && !exp.m_negative && mod != ZERO) {
+		BigInteger reduced = base % mod;
+		uint64_t value = ExpMod64(reduced.WordValue(), exp.WordValue(), mod.WordValue());
+		return reduced.SetWord(value, reduced.m_negative && (exp.WordValue() & 1));
+	}
 	BigInteger result = ONE;
-	BigInteger TWO("2");
 
 	while (exp > ZERO) {
 		// Break down the base and keep it under mod value
@@ -547,9 +966,32 @@ BigInteger BigInteger::ExpMod(BigInteger base, BigInteger exp, BigInteger mod) {
 	return result;
 }
 
+// Finds x such that (num * x) % mod == 1 using the extended Euclidean algorithm.
+// The Bezout coefficients are kept reduced modulo mod so they never go negative.
+BigInteger BigInteger::ModInverse(BigInteger num, BigInteger mod) {
+	BigInteger prevRem = mod;
+	BigInteger rem = num % mod;
+	BigInteger prevCoeff = ZERO;
+	BigInteger coeff = ONE;
+
+	while (rem != ZERO) {
+		BigInteger quotient = prevRem / rem;
+		BigInteger nextRem = prevRem - quotient * rem;
+		// prevCoeff - quotient * coeff, wrapped back into [0, mod)
+		BigInteger nextCoeff = (prevCoeff + mod - (quotient * coeff) % mod) % mod;
+		prevRem = rem;
+		rem = nextRem;
+		prevCoeff = coeff;
+		coeff = nextCoeff;
+	}
+	if (prevRem != ONE) {
+		throw exception("ERROR: Value has no inverse for this modulus.");
+	}
+	return prevCoeff;
+}
 
 // This is POSTFIX operator
-BigInteger & BigInteger::operator++(int)
+BigInteger BigInteger::operator++(int)
 {
 	BigInteger temp = *this;
 	*this += ONE;
@@ -570,21 +1012,12 @@ BigInteger BigInteger::operator|(const BigInteger & rhs) const {
 BigInteger & BigInteger::operator|=(const BigInteger & rhs)
 {
 	// TODO: What if a number is negative ????
-	BigInteger shorterNum, longerNum;
-	// Find the longer of two numbers
+	// The longer of two numbers decides the sign, widen this one in place if needed
 	if (rhs.m_bits.size() > this->m_bits.size()) {
-		longerNum = rhs;
-		shorterNum = *this;
-	}
-	else {
-		longerNum = *this;
-		shorterNum = rhs;
-	}
-
-	for (int i = 0; i < shorterNum.m_bits.size(); i++) {
-		longerNum.m_bits[i] |= shorterNum.m_bits[i];
+		this->m_bits.resize(rhs.m_bits.size(), 0);
+		this->m_negative = rhs.m_negative;
 	}
-	*this = longerNum;
+	GetLimbKernels().orInto(this->m_bits.data(), rhs.m_bits.data(), rhs.m_bits.size());
 	return *this;
 }
 
@@ -595,38 +1028,39 @@ BigInteger BigInteger::operator^(const BigInteger & rhs) const {
 
 BigInteger & BigInteger::operator^=(const BigInteger & rhs) {
 	// TODO: What if a number is negative ????
-	BigInteger shorterNum, longerNum;
-	// Find the longer of two numbers
+	// The longer of two numbers decides the sign, widen this one in place if needed
 	if (rhs.m_bits.size() > this->m_bits.size()) {
-		longerNum = rhs;
-		shorterNum = *this;
-	}
-	else {
-		longerNum = *this;
-		shorterNum = rhs;
+		this->m_bits.resize(rhs.m_bits.size(), 0);
+		this->m_negative = rhs.m_negative;
 	}
+	GetLimbKernels().xorInto(this->m_bits.data(), rhs.m_bits.data(), rhs.m_bits.size());
+	// Equal top limbs cancel out
+	return Resize();
+}
 
-	for (int i = 0; i < shorterNum.m_bits.size(); i++) {
-		longerNum.m_bits[i] ^= shorterNum.m_bits[i];
-	}
-	*this = longerNum;
-	return *this;
+BigRandom & BigInteger::ThreadRandom() {
+	thread_local BigRandom random(std::random_device{}());
+	return random;
 }
 
 // Generates a random number within the bounds provided. Uses the Rabin-Miller
 // primality test to determine how probable the prime found is to actually be prime. 
-BigInteger BigInteger::GenerateLargePrimes(int lower, int upper) {
-	BigInteger random;
+BigInteger BigInteger::GenerateLargePrimes(int lower, int upper, BigRandom & random) {
+	std::uniform_int_distribution<int> interval(lower, upper);
+	BigInteger candidate;
 	do {
 		// Generate a prime in an interval
-		random = lower + (rand() % (upper - lower + 1));
-	} while (!RabinMillerTest(random, 5)); // 5 is arbitrary
-	return random;
+		candidate = interval(random);
+	} while (!RabinMillerTest(candidate, 5, random)); // 5 is arbitrary
+	return candidate;
 }
 
 // Algorithm credit: http://www.sanfoundry.com/cpp-program-implement-miller-rabin-primality-test/
-bool BigInteger::RabinMillerTest(BigInteger probPrime, int iterations) {
-	BigInteger TWO("2");
+bool BigInteger::RabinMillerTest(const BigInteger & probPrime, int iterations, BigRandom & random) {
+	// Candidates below 2^64 get an exact answer from fixed witnesses, no randomness needed
+	if (probPrime.IsWord()) {
+		return !probPrime.m_negative && IsPrime64(probPrime.WordValue());
+	}
 	if (probPrime < TWO) {
 		return false;
 	}
@@ -641,11 +1075,16 @@ bool BigInteger::RabinMillerTest(BigInteger probPrime, int iterations) {
 	}
 	// Iterate over the prime x times to determine if it is prime. More iterations = more accuracy
 	for (int i = 0; i < iterations; i++) {
-		BigInteger random = rand();
-		random = random % (probPrime - ONE) + ONE;
+		// One limb wider than the candidate, so the reduction below is close to uniform
+		LimbVector limbs(probPrime.m_bits.size() + 1, 0);
+		for (size_t j = 0; j < limbs.size(); j++) {
+			limbs[j] = (uint32_t)random();
+		}
+		BigInteger witness = FromLimbs(limbs.data(), limbs.size());
+		witness = witness % (probPrime - ONE) + ONE;
 		BigInteger temp = oneLess;
 
-		BigInteger modulus = ExpMod(random, temp, probPrime);
+		BigInteger modulus = ExpMod(witness, temp, probPrime);
 
 		while (temp != probPrime - ONE && modulus != ONE && modulus != probPrime - ONE) {
 			modulus = (modulus * modulus) % probPrime;
@@ -658,7 +1097,7 @@ bool BigInteger::RabinMillerTest(BigInteger probPrime, int iterations) {
 	return true;
 }
 
-uint32_t BigInteger::BitLength() {
+uint32_t BigInteger::BitLength() const {
 	uint32_t result = 0;
 	uint32_t alreadyFull = 0;
 	
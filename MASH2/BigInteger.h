@@ -6,26 +6,32 @@
 #include <algorithm>
 #include <ostream>
 #include <random>
+#include "BigLiteral.h"
+#include "LimbVector.h"
 using std::exception;
 using std::string;
 using std::vector;
 using std::ostream;
 using std::hex;
 using std::reverse;
-using std::rand;
 
 #define BITS_IN_INTEGER = 32;
 #define HEX_IN_32_BITS = 8;
 
+// Randomness for prime generation and the Rabin-Miller witnesses. Callers may pass
+// their own generator (e.g. a seeded one for reproducible runs); otherwise each
+// thread draws from its own, seeded from std::random_device on first use.
+typedef std::mt19937_64 BigRandom;
 
 class BigInteger {
 	// Ostream Operator
-	friend ostream & operator<<(ostream & os, BigInteger & num);
+	friend ostream & operator<<(ostream & os, const BigInteger & num);
 public:
 	// Constructors 
 	BigInteger();
 	BigInteger(string hex);
 	BigInteger(int num);
+	BigInteger(const BigLiteral & literal);
 	BigInteger(const BigInteger & rhs);
 	BigInteger & operator=(const BigInteger & rhs);
 
@@ -51,21 +57,26 @@ public:
 	BigInteger & operator^=(const BigInteger & rhs);
 
 
-	BigInteger & operator++(int);
+	BigInteger operator++(int);
 	BigInteger & operator++();
 
 	// Helper Functions
-	BigInteger Abs();
-	BigInteger Pow(BigInteger base, BigInteger exp);
-	uint32_t Mod(int32_t a, int32_t b);
-	vector<uint32_t> HexToBinary(string hex);
-	string ToString();
+	BigInteger Abs() const;
+	static BigInteger Pow(BigInteger base, BigInteger exp);
+	static uint32_t Mod(int32_t a, int32_t b);
+	LimbVector HexToBinary(const string & hex);
+	static BigInteger FromDecimal(const string & dec);
+	string ToString() const;
+	string ToDecimal() const;
+	const LimbVector & Limbs() const;
+	static BigInteger FromLimbs(const uint32_t * limbs, size_t count);
 	void SetBit(uint32_t bitPos, bool value);
-	uint32_t GetBit(uint32_t bitPos);
+	uint32_t GetBit(uint32_t bitPos) const;
 	BigInteger & Resize();
-	BigInteger ExpMod(BigInteger base, BigInteger exp, BigInteger mod);
-	uint32_t BitLength();
-	BigInteger InvertBits();
+	static BigInteger ExpMod(BigInteger base, BigInteger exp, BigInteger mod);
+	static BigInteger ModInverse(BigInteger num, BigInteger mod);
+	uint32_t BitLength() const;
+	BigInteger InvertBits() const;
 
 	// Comparison Operators
 	bool operator>(const BigInteger & rhs) const;
@@ -75,10 +86,27 @@ public:
 	bool operator==(const BigInteger & rhs) const;
 	bool operator!=(const BigInteger & rhs) const;
 
-	BigInteger GenerateLargePrimes(int lower, int upper);
-	bool RabinMillerTest(BigInteger probPrime, int iterations);
+	static BigRandom & ThreadRandom();
+	static BigInteger GenerateLargePrimes(int lower, int upper, BigRandom & random = ThreadRandom());
+	static bool RabinMillerTest(const BigInteger & probPrime, int iterations, BigRandom & random = ThreadRandom());
 
 private:
-	vector<uint32_t> m_bits;
+	bool IsWord() const;
+	uint64_t WordValue() const;
+	BigInteger & SetWord(uint64_t value, bool negative);
+	bool AddWord(uint64_t value, bool negative);
+
+	static int CompareMagnitude(const LimbVector & lhs, const LimbVector & rhs);
+	static bool EqualMagnitude(const LimbVector & lhs, const LimbVector & rhs);
+	static void AddMagnitude(LimbVector & lhs, const LimbVector & rhs);
+	static void SubMagnitude(LimbVector & lhs, const LimbVector & rhs);
+	static void DivModMagnitude(const LimbVector & num, const LimbVector & den,
+		LimbVector & quotient, LimbVector & remainder);
+	static LimbVector DecimalToBinary(const char * dec, size_t len, const vector<BigInteger> & powers, size_t level);
+	static void BinaryToDecimal(const BigInteger & num, const vector<BigInteger> & powers,
+		vector<BigInteger> & reciprocals, size_t level, size_t width, string & out);
+	static BigInteger Reciprocal(const BigInteger & den);
+
+	LimbVector m_bits;
 	bool m_negative;
 };
\ No newline at end of file
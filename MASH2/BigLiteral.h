@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+
+// A word-sized integer constant produced entirely at compile time. BigInteger
+// converts from it without parsing or allocating (the value lands in the inline
+// limbs), so 0x101_big costs the same as an integer literal.
+class BigLiteral {
+public:
+	constexpr explicit BigLiteral(uint64_t value) : m_value(value) {
+	}
+	constexpr uint64_t Value() const {
+		return m_value;
+	}
+private:
+	uint64_t m_value;
+};
+
+namespace BigLiteralParse {
+	// 0-15 for hex digits, 255 for anything else
+	constexpr uint64_t DigitValue(char c) {
+		return (c >= '0' && c <= '9') ? (uint64_t)(c - '0')
+			: (c >= 'a' && c <= 'f') ? (uint64_t)(c - 'a' + 10)
+			: (c >= 'A' && c <= 'F') ? (uint64_t)(c - 'A' + 10)
+			: 255;
+	}
+
+	// Folds the digits left to right: Acc * Base + digit
+	template <uint64_t Base, uint64_t Acc, char... Digits>
+	struct Parse;
+
+	template <uint64_t Base, uint64_t Acc>
+	struct Parse<Base, Acc> {
+		static const uint64_t value = Acc;
+	};
+
+	template <uint64_t Base, uint64_t Acc, char Digit, char... Rest>
+	struct Parse<Base, Acc, Digit, Rest...> {
+		static_assert(DigitValue(Digit) < Base, "Invalid digit in _big literal.");
+		static_assert(Acc <= (UINT64_MAX - DigitValue(Digit)) / Base, "_big literal does not fit in 64 bits.");
+		static const uint64_t value = Parse<Base, Acc * Base + DigitValue(Digit), Rest...>::value;
+	};
+
+	// Prefixes follow integer literals: 0x hex, 0b binary, any other leading 0 octal
+	template <char... Digits>
+	struct Literal {
+		static const uint64_t value = Parse<10, 0, Digits...>::value;
+	};
+
+	template <char... Digits>
+	struct Literal<'0', Digits...> {
+		static const uint64_t value = Parse<8, 0, Digits...>::value;
+	};
+
+	template <char... Digits>
+	struct Literal<'0', 'x', Digits...> {
+		static const uint64_t value = Parse<16, 0, Digits...>::value;
+	};
+
+	template <char... Digits>
+	struct Literal<'0', 'X', Digits...> {
+		static const uint64_t value = Parse<16, 0, Digits...>::value;
+	};
+
+	template <char... Digits>
+	struct Literal<'0', 'b', Digits...> {
+		static const uint64_t value = Parse<2, 0, Digits...>::value;
+	};
+
+	template <char... Digits>
+	struct Literal<'0', 'B', Digits...> {
+		static const uint64_t value = Parse<2, 0, Digits...>::value;
+	};
+}
+
+template <char... Digits>
+constexpr BigLiteral operator"" _big() {
+	return BigLiteral(BigLiteralParse::Literal<Digits...>::value);
+}
+
+// Shared compile-time constants. Each translation unit that needs BigInteger
+// operands builds them once from here instead of parsing hex strings.
+namespace BigConstants {
+	constexpr BigLiteral ZERO = 0_big;
+	constexpr BigLiteral ONE = 1_big;
+	constexpr BigLiteral TWO = 2_big;
+	constexpr BigLiteral FOUR = 4_big;
+	constexpr BigLiteral TEN = 0xA_big;
+	constexpr BigLiteral FIFTEEN = 0xF_big;
+	constexpr BigLiteral SIXTEEN = 0x10_big;
+	constexpr BigLiteral TWOFIFTYSEVEN = 0x101_big;
+}
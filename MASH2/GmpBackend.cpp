@@ -0,0 +1,97 @@
+#ifdef MASH2_WITH_GMP
+#include "ArithBackend.h"
+#include <cstring>
+#include <gmp.h>
+
+// libgmp behind the backend interface. GMP allows aliased operands everywhere
+// except where noted.
+class GmpBackend : public ArithBackend {
+public:
+	const char * Name() const {
+		return "gmp";
+	}
+
+	Handle Create() const {
+		mpz_ptr value = new __mpz_struct;
+		mpz_init(value);
+		return reinterpret_cast<Handle>(value);
+	}
+
+	void Destroy(Handle value) const {
+		mpz_clear(Value(value));
+		delete Value(value);
+	}
+
+	void Copy(Handle dst, Handle src) const {
+		mpz_set(Value(dst), Value(src));
+	}
+
+	void Import(Handle dst, const uint8_t * bytes, size_t count) const {
+		mpz_import(Value(dst), count, 1, 1, 1, 0, bytes);
+	}
+
+	void Export(Handle src, uint8_t * bytes, size_t count) const {
+		size_t size = (mpz_sizeinbase(Value(src), 2) + 7) / 8;
+		if (size > count) {
+			throw exception("ERROR: Value does not fit the export buffer.");
+		}
+		memset(bytes, 0, count);
+		mpz_export(bytes + count - size, nullptr, 1, 1, 1, 0, Value(src));
+	}
+
+	void Add(Handle dst, Handle a, Handle b) const {
+		mpz_add(Value(dst), Value(a), Value(b));
+	}
+
+	void Sub(Handle dst, Handle a, Handle b) const {
+		mpz_sub(Value(dst), Value(a), Value(b));
+	}
+
+	void Mul(Handle dst, Handle a, Handle b) const {
+		mpz_mul(Value(dst), Value(a), Value(b));
+	}
+
+	void Mod(Handle dst, Handle a, Handle mod) const {
+		mpz_mod(Value(dst), Value(a), Value(mod));
+	}
+
+	void MulMod(Handle dst, Handle a, Handle b, Handle mod) const {
+		// The product goes to a temporary in case dst is the modulus
+		mpz_t product;
+		mpz_init(product);
+		mpz_mul(product, Value(a), Value(b));
+		mpz_mod(Value(dst), product, Value(mod));
+		mpz_clear(product);
+	}
+
+	void PowMod(Handle dst, Handle base, uint32_t exp, Handle mod) const {
+		mpz_powm_ui(Value(dst), Value(base), exp, Value(mod));
+	}
+
+	void ShiftLeft(Handle dst, Handle a, size_t bits) const {
+		mpz_mul_2exp(Value(dst), Value(a), bits);
+	}
+
+	void LowBits(Handle dst, Handle a, size_t bits) const {
+		mpz_fdiv_r_2exp(Value(dst), Value(a), bits);
+	}
+
+	void Or(Handle dst, Handle a, Handle b) const {
+		mpz_ior(Value(dst), Value(a), Value(b));
+	}
+
+	void Xor(Handle dst, Handle a, Handle b) const {
+		mpz_xor(Value(dst), Value(a), Value(b));
+	}
+
+private:
+	static mpz_ptr Value(Handle value) {
+		return reinterpret_cast<mpz_ptr>(value);
+	}
+};
+
+const ArithBackend & GmpArithBackend() {
+	static const GmpBackend backend;
+	return backend;
+}
+#endif
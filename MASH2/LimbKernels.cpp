@@ -0,0 +1,463 @@
+#include "LimbKernels.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LIMB_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC accepts any intrinsic without per-function target flags
+#define LIMB_TARGET(isa)
+// AVX-512 intrinsics arrived with VS2017 15.3
+#if _MSC_VER >= 1911
+#define LIMB_KERNELS_AVX512
+#endif
+#else
+#include <cpuid.h>
+#define LIMB_TARGET(isa) __attribute__((target(isa)))
+#define LIMB_KERNELS_AVX512
+#endif
+#endif
+
+// ---- Portable scalar kernels, also used for the tails of the vector loops ----
+
+static void OrScalar(uint32_t * dst, const uint32_t * src, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		dst[i] |= src[i];
+	}
+}
+
+static void XorScalar(uint32_t * dst, const uint32_t * src, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		dst[i] ^= src[i];
+	}
+}
+
+static void InvertScalar(uint32_t * dst, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		dst[i] = ~dst[i];
+	}
+}
+
+static bool EqualScalar(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	return count == 0 || memcmp(lhs, rhs, count * sizeof(uint32_t)) == 0;
+}
+
+static int CompareScalar(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	for (size_t i = count; i-- > 0;) {
+		if (lhs[i] != rhs[i]) {
+			return lhs[i] > rhs[i] ? 1 : -1;
+		}
+	}
+	return 0;
+}
+
+// Shifts limbs [1, end) left, walking down so each source limb is read before it is overwritten
+static void ShiftLeftTail(uint32_t * limbs, size_t end, unsigned bits) {
+	for (size_t i = end; i-- > 1;) {
+		limbs[i] = (limbs[i] << bits) | (limbs[i - 1] >> (32 - bits));
+	}
+	limbs[0] <<= bits;
+}
+
+static uint32_t ShiftLeftScalar(uint32_t * limbs, size_t count, unsigned bits) {
+	if (count == 0) {
+		return 0;
+	}
+	uint32_t carry = limbs[count - 1] >> (32 - bits);
+	ShiftLeftTail(limbs, count, bits);
+	return carry;
+}
+
+// Shifts limbs [begin, count) right, walking up
+static void ShiftRightTail(uint32_t * limbs, size_t begin, size_t count, unsigned bits) {
+	if (count == 0) {
+		return;
+	}
+	for (size_t i = begin; i + 1 < count; i++) {
+		limbs[i] = (limbs[i] >> bits) | (limbs[i + 1] << (32 - bits));
+	}
+	limbs[count - 1] >>= bits;
+}
+
+static void ShiftRightScalar(uint32_t * limbs, size_t count, unsigned bits) {
+	ShiftRightTail(limbs, 0, count, bits);
+}
+
+static const LimbKernels SCALAR_KERNELS = {
+	"scalar", OrScalar, XorScalar, InvertScalar, EqualScalar, CompareScalar, ShiftLeftScalar, ShiftRightScalar
+};
+
+#ifdef LIMB_KERNELS_X86
+
+// ---- SSE2, 4 limbs per step ----
+
+LIMB_TARGET("sse2") static void OrSse2(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(a, b));
+	}
+	OrScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("sse2") static void XorSse2(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a, b));
+	}
+	XorScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("sse2") static void InvertSse2(uint32_t * dst, size_t count) {
+	const __m128i ones = _mm_set1_epi32(-1);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a, ones));
+	}
+	InvertScalar(dst + i, count - i);
+}
+
+LIMB_TARGET("sse2") static bool EqualSse2(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 4; i -= 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(lhs + i - 4));
+		__m128i b = _mm_loadu_si128((const __m128i *)(rhs + i - 4));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xFFFF) {
+			return false;
+		}
+	}
+	return EqualScalar(lhs, rhs, i);
+}
+
+LIMB_TARGET("sse2") static int CompareSse2(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 4; i -= 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(lhs + i - 4));
+		__m128i b = _mm_loadu_si128((const __m128i *)(rhs + i - 4));
+		// Only the block holding the first difference is resolved limb by limb
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xFFFF) {
+			return CompareScalar(lhs + i - 4, rhs + i - 4, 4);
+		}
+	}
+	return CompareScalar(lhs, rhs, i);
+}
+
+// Each block pairs limbs [i, i + 4) with the unaligned load of [i - 1, i + 3), so
+// the bits crossing limb boundaries come from a second vector instead of a shuffle.
+LIMB_TARGET("sse2") static uint32_t ShiftLeftSse2(uint32_t * limbs, size_t count, unsigned bits) {
+	if (count == 0) {
+		return 0;
+	}
+	uint32_t carry = limbs[count - 1] >> (32 - bits);
+	const __m128i up = _mm_cvtsi32_si128((int)bits);
+	const __m128i down = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = count;
+	for (; i >= 5; i -= 4) {
+		__m128i cur = _mm_loadu_si128((const __m128i *)(limbs + i - 4));
+		__m128i prev = _mm_loadu_si128((const __m128i *)(limbs + i - 5));
+		_mm_storeu_si128((__m128i *)(limbs + i - 4), _mm_or_si128(_mm_sll_epi32(cur, up), _mm_srl_epi32(prev, down)));
+	}
+	ShiftLeftTail(limbs, i, bits);
+	return carry;
+}
+
+LIMB_TARGET("sse2") static void ShiftRightSse2(uint32_t * limbs, size_t count, unsigned bits) {
+	const __m128i down = _mm_cvtsi32_si128((int)bits);
+	const __m128i up = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = 0;
+	for (; i + 4 < count; i += 4) {
+		__m128i cur = _mm_loadu_si128((const __m128i *)(limbs + i));
+		__m128i next = _mm_loadu_si128((const __m128i *)(limbs + i + 1));
+		_mm_storeu_si128((__m128i *)(limbs + i), _mm_or_si128(_mm_srl_epi32(cur, down), _mm_sll_epi32(next, up)));
+	}
+	ShiftRightTail(limbs, i, count, bits);
+}
+
+static const LimbKernels SSE2_KERNELS = {
+	"sse2", OrSse2, XorSse2, InvertSse2, EqualSse2, CompareSse2, ShiftLeftSse2, ShiftRightSse2
+};
+
+// ---- AVX2, 8 limbs per step ----
+
+LIMB_TARGET("avx2") static void OrAvx2(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(a, b));
+	}
+	OrScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("avx2") static void XorAvx2(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(a, b));
+	}
+	XorScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("avx2") static void InvertAvx2(uint32_t * dst, size_t count) {
+	const __m256i ones = _mm256_set1_epi32(-1);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(a, ones));
+	}
+	InvertScalar(dst + i, count - i);
+}
+
+LIMB_TARGET("avx2") static bool EqualAvx2(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 8; i -= 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(lhs + i - 8));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(rhs + i - 8));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)) != -1) {
+			return false;
+		}
+	}
+	return EqualScalar(lhs, rhs, i);
+}
+
+LIMB_TARGET("avx2") static int CompareAvx2(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 8; i -= 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(lhs + i - 8));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(rhs + i - 8));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)) != -1) {
+			return CompareScalar(lhs + i - 8, rhs + i - 8, 8);
+		}
+	}
+	return CompareScalar(lhs, rhs, i);
+}
+
+LIMB_TARGET("avx2") static uint32_t ShiftLeftAvx2(uint32_t * limbs, size_t count, unsigned bits) {
+	if (count == 0) {
+		return 0;
+	}
+	uint32_t carry = limbs[count - 1] >> (32 - bits);
+	const __m128i up = _mm_cvtsi32_si128((int)bits);
+	const __m128i down = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = count;
+	for (; i >= 9; i -= 8) {
+		__m256i cur = _mm256_loadu_si256((const __m256i *)(limbs + i - 8));
+		__m256i prev = _mm256_loadu_si256((const __m256i *)(limbs + i - 9));
+		_mm256_storeu_si256((__m256i *)(limbs + i - 8), _mm256_or_si256(_mm256_sll_epi32(cur, up), _mm256_srl_epi32(prev, down)));
+	}
+	ShiftLeftTail(limbs, i, bits);
+	return carry;
+}
+
+LIMB_TARGET("avx2") static void ShiftRightAvx2(uint32_t * limbs, size_t count, unsigned bits) {
+	const __m128i down = _mm_cvtsi32_si128((int)bits);
+	const __m128i up = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = 0;
+	for (; i + 8 < count; i += 8) {
+		__m256i cur = _mm256_loadu_si256((const __m256i *)(limbs + i));
+		__m256i next = _mm256_loadu_si256((const __m256i *)(limbs + i + 1));
+		_mm256_storeu_si256((__m256i *)(limbs + i), _mm256_or_si256(_mm256_srl_epi32(cur, down), _mm256_sll_epi32(next, up)));
+	}
+	ShiftRightTail(limbs, i, count, bits);
+}
+
+static const LimbKernels AVX2_KERNELS = {
+	"avx2", OrAvx2, XorAvx2, InvertAvx2, EqualAvx2, CompareAvx2, ShiftLeftAvx2, ShiftRightAvx2
+};
+
+#ifdef LIMB_KERNELS_AVX512
+
+// ---- AVX-512F, 16 limbs per step ----
+
+LIMB_TARGET("avx512f") static void OrAvx512(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m512i a = _mm512_loadu_si512((const void *)(dst + i));
+		__m512i b = _mm512_loadu_si512((const void *)(src + i));
+		_mm512_storeu_si512((void *)(dst + i), _mm512_or_si512(a, b));
+	}
+	OrScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("avx512f") static void XorAvx512(uint32_t * dst, const uint32_t * src, size_t count) {
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m512i a = _mm512_loadu_si512((const void *)(dst + i));
+		__m512i b = _mm512_loadu_si512((const void *)(src + i));
+		_mm512_storeu_si512((void *)(dst + i), _mm512_xor_si512(a, b));
+	}
+	XorScalar(dst + i, src + i, count - i);
+}
+
+LIMB_TARGET("avx512f") static void InvertAvx512(uint32_t * dst, size_t count) {
+	const __m512i ones = _mm512_set1_epi32(-1);
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m512i a = _mm512_loadu_si512((const void *)(dst + i));
+		_mm512_storeu_si512((void *)(dst + i), _mm512_xor_si512(a, ones));
+	}
+	InvertScalar(dst + i, count - i);
+}
+
+LIMB_TARGET("avx512f") static bool EqualAvx512(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 16; i -= 16) {
+		__m512i a = _mm512_loadu_si512((const void *)(lhs + i - 16));
+		__m512i b = _mm512_loadu_si512((const void *)(rhs + i - 16));
+		if (_mm512_cmpneq_epi32_mask(a, b) != 0) {
+			return false;
+		}
+	}
+	return EqualScalar(lhs, rhs, i);
+}
+
+LIMB_TARGET("avx512f") static int CompareAvx512(const uint32_t * lhs, const uint32_t * rhs, size_t count) {
+	size_t i = count;
+	for (; i >= 16; i -= 16) {
+		__m512i a = _mm512_loadu_si512((const void *)(lhs + i - 16));
+		__m512i b = _mm512_loadu_si512((const void *)(rhs + i - 16));
+		if (_mm512_cmpneq_epi32_mask(a, b) != 0) {
+			return CompareScalar(lhs + i - 16, rhs + i - 16, 16);
+		}
+	}
+	return CompareScalar(lhs, rhs, i);
+}
+
+LIMB_TARGET("avx512f") static uint32_t ShiftLeftAvx512(uint32_t * limbs, size_t count, unsigned bits) {
+	if (count == 0) {
+		return 0;
+	}
+	uint32_t carry = limbs[count - 1] >> (32 - bits);
+	const __m128i up = _mm_cvtsi32_si128((int)bits);
+	const __m128i down = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = count;
+	for (; i >= 17; i -= 16) {
+		__m512i cur = _mm512_loadu_si512((const void *)(limbs + i - 16));
+		__m512i prev = _mm512_loadu_si512((const void *)(limbs + i - 17));
+		_mm512_storeu_si512((void *)(limbs + i - 16), _mm512_or_si512(_mm512_sll_epi32(cur, up), _mm512_srl_epi32(prev, down)));
+	}
+	ShiftLeftTail(limbs, i, bits);
+	return carry;
+}
+
+LIMB_TARGET("avx512f") static void ShiftRightAvx512(uint32_t * limbs, size_t count, unsigned bits) {
+	const __m128i down = _mm_cvtsi32_si128((int)bits);
+	const __m128i up = _mm_cvtsi32_si128((int)(32 - bits));
+	size_t i = 0;
+	for (; i + 16 < count; i += 16) {
+		__m512i cur = _mm512_loadu_si512((const void *)(limbs + i));
+		__m512i next = _mm512_loadu_si512((const void *)(limbs + i + 1));
+		_mm512_storeu_si512((void *)(limbs + i), _mm512_or_si512(_mm512_srl_epi32(cur, down), _mm512_sll_epi32(next, up)));
+	}
+	ShiftRightTail(limbs, i, count, bits);
+}
+
+static const LimbKernels AVX512_KERNELS = {
+	"avx512", OrAvx512, XorAvx512, InvertAvx512, EqualAvx512, CompareAvx512, ShiftLeftAvx512, ShiftRightAvx512
+};
+
+#endif
+
+// ---- CPU feature detection ----
+
+static void CpuId(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuidex(info, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; i++) {
+		regs[i] = (uint32_t)info[i];
+	}
+#else
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+	__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+}
+
+// Which register state the OS saves on context switch (XCR0)
+static uint64_t OsSavedState() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static const LimbKernels & DetectLimbKernels() {
+	uint32_t regs[4];
+	CpuId(0, 0, regs);
+	uint32_t maxLeaf = regs[0];
+	CpuId(1, 0, regs);
+	bool sse2 = (regs[3] & (1u << 26)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	bool avx2 = false;
+	bool avx512 = false;
+	if (osxsave && avx && maxLeaf >= 7) {
+		uint64_t xcr0 = OsSavedState();
+		CpuId(7, 0, regs);
+		// XMM and YMM state
+		avx2 = (xcr0 & 0x6) == 0x6 && (regs[1] & (1u << 5)) != 0;
+		// Plus opmask and both halves of ZMM
+		avx512 = (xcr0 & 0xE6) == 0xE6 && (regs[1] & (1u << 16)) != 0;
+	}
+#ifdef LIMB_KERNELS_AVX512
+	if (avx512) {
+		return AVX512_KERNELS;
+	}
+#else
+	(void)avx512;
+#endif
+	if (avx2) {
+		return AVX2_KERNELS;
+	}
+	if (sse2) {
+		return SSE2_KERNELS;
+	}
+	return SCALAR_KERNELS;
+}
+
+#endif
+
+// Applies MASH2_LIMB_KERNELS, which may only lower the detected level
+static const LimbKernels & SelectLimbKernels() {
+#ifdef LIMB_KERNELS_X86
+	const LimbKernels * order[] = {
+#ifdef LIMB_KERNELS_AVX512
+		&AVX512_KERNELS,
+#endif
+		&AVX2_KERNELS, &SSE2_KERNELS, &SCALAR_KERNELS
+	};
+	const size_t levels = sizeof(order) / sizeof(order[0]);
+	const LimbKernels & detected = DetectLimbKernels();
+	const char * requested = std::getenv("MASH2_LIMB_KERNELS");
+	size_t best = 0;
+	while (order[best] != &detected) {
+		best++;
+	}
+	if (requested != nullptr) {
+		for (size_t i = best; i < levels; i++) {
+			if (strcmp(order[i]->name, requested) == 0) {
+				return *order[i];
+			}
+		}
+	}
+	return detected;
+#else
+	return SCALAR_KERNELS;
+#endif
+}
+
+const LimbKernels & GetLimbKernels() {
+	// Resolved once, on first use
+	static const LimbKernels & kernels = SelectLimbKernels();
+	return kernels;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Linear passes over little-endian uint32_t limb arrays. One implementation per
+// instruction set; the widest one the CPU and OS support is picked on first use.
+// Setting MASH2_LIMB_KERNELS to scalar, sse2, avx2 or avx512 forces a lower one.
+struct LimbKernels {
+	const char * name;
+	// dst[i] |= src[i] / dst[i] ^= src[i] / dst[i] = ~dst[i] for i < count
+	void (*orInto)(uint32_t * dst, const uint32_t * src, size_t count);
+	void (*xorInto)(uint32_t * dst, const uint32_t * src, size_t count);
+	void (*invert)(uint32_t * dst, size_t count);
+	// Compare count limbs starting from the most significant one
+	bool (*equal)(const uint32_t * lhs, const uint32_t * rhs, size_t count);
+	int (*compare)(const uint32_t * lhs, const uint32_t * rhs, size_t count);
+	// In-place shift by 1..31 bits. Left returns the bits carried out of the top limb;
+	// right shifts zeros into the top limb.
+	uint32_t (*shiftLeft)(uint32_t * limbs, size_t count, unsigned bits);
+	void (*shiftRight)(uint32_t * limbs, size_t count, unsigned bits);
+};
+
+const LimbKernels & GetLimbKernels();
@@ -0,0 +1,192 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Number of limbs stored inside the object itself. Two limbs hold any 64-bit value,
+// so loop counters, small constants and prime candidates never touch the heap.
+#define LIMB_INLINE_CAPACITY 2
+
+// The subset of vector<uint32_t> BigInteger needs, with inline storage for small
+// values. Grows onto the heap automatically once a value outgrows one machine word.
+class LimbVector {
+public:
+	typedef uint32_t * iterator;
+	typedef const uint32_t * const_iterator;
+
+	LimbVector() : m_data(m_inline), m_size(0), m_capacity(LIMB_INLINE_CAPACITY) {
+	}
+
+	LimbVector(size_t count, uint32_t value) : m_data(m_inline), m_size(0), m_capacity(LIMB_INLINE_CAPACITY) {
+		assign(count, value);
+	}
+
+	LimbVector(const uint32_t * first, const uint32_t * last) : m_data(m_inline), m_size(0), m_capacity(LIMB_INLINE_CAPACITY) {
+		assign(first, last);
+	}
+
+	LimbVector(const LimbVector & rhs) : m_data(m_inline), m_size(rhs.m_size), m_capacity(LIMB_INLINE_CAPACITY) {
+		// Word-sized values copy the whole inline block without a size-dependent loop
+		if (m_size <= LIMB_INLINE_CAPACITY) {
+			memcpy(m_inline, rhs.m_data, sizeof(m_inline));
+		}
+		else {
+			m_size = 0;
+			assign(rhs.begin(), rhs.end());
+		}
+	}
+
+	LimbVector(LimbVector && rhs) : m_data(m_inline), m_size(0), m_capacity(LIMB_INLINE_CAPACITY) {
+		Steal(rhs);
+	}
+
+	~LimbVector() {
+		Release();
+	}
+
+	LimbVector & operator=(const LimbVector & rhs) {
+		if (this != &rhs) {
+			assign(rhs.begin(), rhs.end());
+		}
+		return *this;
+	}
+
+	LimbVector & operator=(LimbVector && rhs) {
+		if (this != &rhs) {
+			Release();
+			m_data = m_inline;
+			m_size = 0;
+			m_capacity = LIMB_INLINE_CAPACITY;
+			Steal(rhs);
+		}
+		return *this;
+	}
+
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	bool IsInline() const { return m_data == m_inline; }
+	uint32_t * data() { return m_data; }
+	const uint32_t * data() const { return m_data; }
+	iterator begin() { return m_data; }
+	iterator end() { return m_data + m_size; }
+	const_iterator begin() const { return m_data; }
+	const_iterator end() const { return m_data + m_size; }
+	uint32_t & operator[](size_t i) { return m_data[i]; }
+	const uint32_t & operator[](size_t i) const { return m_data[i]; }
+	uint32_t & back() { return m_data[m_size - 1]; }
+	const uint32_t & back() const { return m_data[m_size - 1]; }
+
+	void clear() {
+		m_size = 0;
+	}
+
+	// Stores a 64-bit value as one limb, or two when the high half is set. Every
+	// buffer holds at least two limbs, so this never reallocates.
+	void AssignWord(uint64_t value) {
+		m_data[0] = (uint32_t)value;
+		m_data[1] = (uint32_t)(value >> 32);
+		m_size = (value >> 32) ? 2 : 1;
+	}
+
+	void reserve(size_t count) {
+		if (count > m_capacity) {
+			Grow(count);
+		}
+	}
+
+	void push_back(uint32_t value) {
+		if (m_size == m_capacity) {
+			Grow(m_capacity * 2);
+		}
+		m_data[m_size++] = value;
+	}
+
+	void pop_back() {
+		m_size--;
+	}
+
+	void resize(size_t count, uint32_t value = 0) {
+		reserve(count);
+		for (size_t i = m_size; i < count; i++) {
+			m_data[i] = value;
+		}
+		m_size = count;
+	}
+
+	void assign(size_t count, uint32_t value) {
+		m_size = 0;
+		resize(count, value);
+	}
+
+	void assign(const uint32_t * first, const uint32_t * last) {
+		size_t count = (size_t)(last - first);
+		m_size = 0;
+		reserve(count);
+		if (count) {
+			memmove(m_data, first, count * sizeof(uint32_t));
+		}
+		m_size = count;
+	}
+
+	// Inserts count copies of value before pos
+	void insert(iterator pos, size_t count, uint32_t value) {
+		size_t offset = (size_t)(pos - m_data);
+		reserve(m_size + count);
+		memmove(m_data + offset + count, m_data + offset, (m_size - offset) * sizeof(uint32_t));
+		for (size_t i = 0; i < count; i++) {
+			m_data[offset + i] = value;
+		}
+		m_size += count;
+	}
+
+	void erase(iterator first, iterator last) {
+		size_t count = (size_t)(last - first);
+		memmove(first, last, (size_t)(end() - last) * sizeof(uint32_t));
+		m_size -= count;
+	}
+
+private:
+	void Grow(size_t capacity) {
+		if (capacity < LIMB_INLINE_CAPACITY * 2) {
+			capacity = LIMB_INLINE_CAPACITY * 2;
+		}
+		uint32_t * grown = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+		if (grown == nullptr) {
+			throw std::bad_alloc();
+		}
+		if (m_size) {
+			memcpy(grown, m_data, m_size * sizeof(uint32_t));
+		}
+		Release();
+		m_data = grown;
+		m_capacity = capacity;
+	}
+
+	void Release() {
+		if (m_data != m_inline) {
+			free(m_data);
+		}
+	}
+
+	// Takes rhs's heap buffer, or copies its inline limbs. Leaves rhs empty.
+	void Steal(LimbVector & rhs) {
+		if (rhs.m_data == rhs.m_inline) {
+			memcpy(m_inline, rhs.m_inline, rhs.m_size * sizeof(uint32_t));
+		}
+		else {
+			m_data = rhs.m_data;
+			m_capacity = rhs.m_capacity;
+			rhs.m_data = rhs.m_inline;
+			rhs.m_capacity = LIMB_INLINE_CAPACITY;
+		}
+		m_size = rhs.m_size;
+		rhs.m_size = 0;
+	}
+
+	uint32_t * m_data;
+	size_t m_size;
+	size_t m_capacity;
+	uint32_t m_inline[LIMB_INLINE_CAPACITY];
+};
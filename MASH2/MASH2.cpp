@@ -1,99 +1,260 @@
 #include "MASH2.h"
+#include "Trace.h"
 #include <iostream>
 
-MASH2::MASH2() : ZERO("0"), ONE("1"), TWO("2"), TEN("A"), FIFTEEN("F"), SIXTEEN("10"), TWOFIFTYSEVEN("101") {
-	//firstPrime = firstPrime.GenerateLargePrimes(MIN_STRONG_PRIME, 1000);
+// Shared by every instance; built once from compile-time literals
+static const BigInteger ONE(BigConstants::ONE);
+static const BigInteger TWO(BigConstants::TWO);
+static const BigInteger FOUR(BigConstants::FOUR);
+static const BigInteger FIFTEEN(BigConstants::FIFTEEN);
+// The MASH-2 exponent
+static const uint32_t EXPONENT = (uint32_t)BigConstants::TWOFIFTYSEVEN.Value();
+// High nibbles of the expanded message and length blocks
+static const uint8_t MESSAGE_NIBBLE = 0xF0;
+static const uint8_t LENGTH_NIBBLE = 0xA0;
+
+MASH2::MASH2() : m_hasFactors(true), m_useCrt(false) {
+	//firstPrime = BigInteger::GenerateLargePrimes(MIN_STRONG_PRIME, 1000);
 	firstPrime = BigInteger(MIN_STRONG_PRIME);
-	secPrime = BigInteger("209");
-	//secPrime = secPrime.GenerateLargePrimes(MIN_STRONG_PRIME, 1000);
+	secPrime = 0x209_big;
+	//secPrime = BigInteger::GenerateLargePrimes(MIN_STRONG_PRIME, 1000);
+	Init();
+}
+
+// Builds the hash from a known factorization of the modulus. Passing useCrt
+// splits the per-block exponentiation across the two factors.
+MASH2::MASH2(const BigInteger & p, const BigInteger & q, bool useCrt) : m_hasFactors(true), m_useCrt(useCrt) {
+	firstPrime = p;
+	secPrime = q;
+	Init();
+}
+
+// Builds the hash from precomputed parameters without deriving anything.
+// CRT is only used when the parameters carry the factorization.
+MASH2::MASH2(const MASH2Params & params, bool useCrt) : m_modulus(params.modulus), m_hasFactors(params.hasFactors), m_useCrt(useCrt && params.hasFactors), m_blockBits(params.blockBits),
+	m_reduceModulus(params.reduceModulus), m_padConstant(params.padConstant), m_maxMessageBits(params.maxMessageBits) {
+	if (m_hasFactors) {
+		firstPrime = params.firstPrime;
+		secPrime = params.secPrime;
+		m_secPrimeInv = params.secPrimeInv;
+	}
+	SetBackend(GetArithBackend());
+}
+
+// Derives the modulus and the CRT recombination constant from the factors.
+void MASH2::Init() {
 	m_modulus = firstPrime * secPrime;
+	m_secPrimeInv = BigInteger::ModInverse(secPrime, firstPrime);
+	InitPadding();
+	SetBackend(GetArithBackend());
+}
+
+// Derives the block size and padding constants from the modulus.
+void MASH2::InitPadding() {
+	// Get the next multiple of 16 from the modulus
+	m_blockBits = (m_modulus.BitLength() >> 4) * 16;
+	m_reduceModulus = BigInteger::Pow(TWO, m_blockBits);
+	m_padConstant = FIFTEEN * (BigInteger::Pow(TWO, m_blockBits - FOUR));
+	m_maxMessageBits = BigInteger::Pow(TWO, m_blockBits >> ONE);
+}
+
+MASH2Params MASH2::Parameters() const {
+	MASH2Params params;
+	params.modulus = m_modulus;
+	params.hasFactors = m_hasFactors;
+	if (m_hasFactors) {
+		params.firstPrime = firstPrime;
+		params.secPrime = secPrime;
+		params.secPrimeInv = m_secPrimeInv;
+	}
+	params.blockBits = m_blockBits;
+	params.reduceModulus = m_reduceModulus;
+	params.padConstant = m_padConstant;
+	params.maxMessageBits = m_maxMessageBits;
+	return params;
+}
+
+void MASH2::SetUseCrt(bool useCrt) {
+	m_useCrt = useCrt && m_hasFactors;
+}
+
+// Hands the constants Digest needs to the backend once, instead of per block.
+void MASH2::SetBackend(const ArithBackend & backend) {
+	m_backend = &backend;
+	m_blockBytes = m_blockBits.Limbs()[0] / 8;
+	m_modulusValue = ArithNumber(backend, m_modulus);
+	m_padValue = ArithNumber(backend, m_padConstant);
+	if (m_hasFactors) {
+		m_firstPrimeValue = ArithNumber(backend, firstPrime);
+		m_secPrimeValue = ArithNumber(backend, secPrime);
+		m_secPrimeInvValue = ArithNumber(backend, m_secPrimeInv);
+	}
+}
+
+const ArithBackend & MASH2::Backend() const {
+	return *m_backend;
+}
+
+// Computes base ^ 257 mod m_modulus. With CRT enabled the exponentiation runs
+// modulo each factor on half-size operands and is recombined with Garner's formula:
+//     h = q^-1 * (m_p - m_q) mod p,  result = m_q + h * q
+// which is the same value the direct path produces.
+void MASH2::ExpModulus(ArithNumber & result, const ArithNumber & base) const {
+	const ArithBackend & backend = *m_backend;
+	if (!m_useCrt) {
+		backend.PowMod(result.Get(), base.Get(), EXPONENT, m_modulusValue.Get());
+		return;
+	}
+	ArithNumber firstResult(backend);
+	ArithNumber secResult(backend);
+	ArithNumber h(backend);
+	backend.Mod(firstResult.Get(), base.Get(), m_firstPrimeValue.Get());
+	backend.PowMod(firstResult.Get(), firstResult.Get(), EXPONENT, m_firstPrimeValue.Get());
+	backend.Mod(secResult.Get(), base.Get(), m_secPrimeValue.Get());
+	backend.PowMod(secResult.Get(), secResult.Get(), EXPONENT, m_secPrimeValue.Get());
+
+	// Keep the difference non-negative before reducing: m_p + (p - m_q mod p)
+	backend.Mod(h.Get(), secResult.Get(), m_firstPrimeValue.Get());
+	backend.Sub(h.Get(), m_firstPrimeValue.Get(), h.Get());
+	backend.Add(h.Get(), h.Get(), firstResult.Get());
+	backend.MulMod(h.Get(), m_secPrimeInvValue.Get(), h.Get(), m_firstPrimeValue.Get());
+	backend.Mul(h.Get(), h.Get(), m_secPrimeValue.Get());
+	backend.Add(result.Get(), secResult.Get(), h.Get());
+}
+
+// Spreads the n / 2 bits of a block over n bits: every nibble, most significant
+// first, becomes one byte under the given high nibble.
+void MASH2::ExpandBlock(const uint8_t * block, uint8_t highNibble, uint8_t * expanded) const {
+	for (size_t i = 0; i < m_blockBytes / 2; i++) {
+		expanded[i * 2] = highNibble | (block[i] >> 4);
+		expanded[i * 2 + 1] = highNibble | (block[i] & 0xF);
+	}
 }
 
 string MASH2::MessageToHex(const string & msg) {
-	std::stringstream stream;
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+	string hex(msg.length() * 2, '0');
 
+	// Two nibbles per byte, written straight into the output buffer
 	for (string::size_type i = 0; i < msg.length(); ++i) {
-		stream.fill('0');
-		stream.width(2);
-		stream << std::hex << (int)msg[i];
+		unsigned char byte = (unsigned char)msg[i];
+		hex[i * 2] = HEX_DIGITS[byte >> 4];
+		hex[i * 2 + 1] = HEX_DIGITS[byte & 0xF];
 	}
 
-	return stream.str();
+	return hex;
 }
 
-string MASH2::Digest(string msg) {
-	// Convert message and message length into integers
-	BigInteger message(MessageToHex(msg));
-	// Passes uint32_t
-	BigInteger messageBitLength(message.BitLength());
+// Binds fresh working values to this instance's backend; the chain starts at zero.
+void MASH2::InitState(BlockState & state) const {
+	state.chain = ArithNumber(*m_backend);
+	state.value = ArithNumber(*m_backend);
+	state.expanded = ArithNumber(*m_backend);
+	state.bytes.assign(m_blockBytes, 0);
+}
 
-	// Get the next multiple of 16 from the modulus
-	BigInteger FOUR("4");
-	BigInteger largest16Multiple = (m_modulus.BitLength() >> 4) * 16;
-
-	// 2 ^ (largest16Multiple / 2)
-	BigInteger temp = TWO;
-	BigInteger limit = (largest16Multiple >> ONE) - ONE;
-	for (BigInteger i = ZERO; i < limit; i++) {
-		temp *= TWO;
+void MASH2::CheckMessageBits(uint64_t messageBits) const {
+	uint32_t limbs[2] = { (uint32_t)messageBits, (uint32_t)(messageBits >> 32) };
+	if (BigInteger::FromLimbs(limbs, 2) > m_maxMessageBits) {
+		throw new exception("ERROR: The message is too long. Please try again.");
 	}
+}
 
-	if (messageBitLength > temp) {
-		throw new exception("ERROR: The message is too long. Please try again.");
+// One round of the compression function on n / 2 bits of message:
+//     chain = (((chain << n) | expand(block) | A) ^ 257 mod N) mod 2^n
+void MASH2::Compress(BlockState & state, const uint8_t * block) const {
+	TRACE_SCOPE("Block");
+	const ArithBackend & backend = *m_backend;
+	{
+		TRACE_SCOPE("Expand");
+		ExpandBlock(block, MESSAGE_NIBBLE, state.bytes.data());
+		backend.Import(state.expanded.Get(), state.bytes.data(), state.bytes.size());
+		// The previous chaining value sits above the expanded block
+		backend.ShiftLeft(state.value.Get(), state.chain.Get(), m_blockBytes * 8);
+		backend.Or(state.value.Get(), state.value.Get(), state.expanded.Get());
+		backend.Or(state.value.Get(), state.value.Get(), m_padValue.Get());
+	}
+	{
+		TRACE_SCOPE("ExpMod");
+		ExpModulus(state.value, state.value);
+	}
+	{
+		TRACE_SCOPE("Reduce");
+		backend.LowBits(state.chain.Get(), state.value.Get(), m_blockBytes * 8);
 	}
+}
+
+// Mixes the low n / 2 bits of the message bit length, expanded under 0xA, into the
+// chain. The chain is the digest afterwards.
+void MASH2::Finish(BlockState & state, uint64_t messageBits) const {
+	TRACE_SCOPE("LengthBlock");
+	const ArithBackend & backend = *m_backend;
+	const size_t halfBytes = m_blockBytes / 2;
+	vector<uint8_t> lengthBytes(halfBytes, 0);
+	for (size_t k = 0; k < sizeof(messageBits) && k < halfBytes; k++) {
+		lengthBytes[halfBytes - 1 - k] = (uint8_t)(messageBits >> (8 * k));
+	}
+	ExpandBlock(lengthBytes.data(), LENGTH_NIBBLE, state.bytes.data());
+	backend.Import(state.value.Get(), state.bytes.data(), state.bytes.size());
+	backend.Xor(state.value.Get(), state.value.Get(), state.chain.Get());
+	backend.Or(state.value.Get(), state.value.Get(), m_padValue.Get());
+	ExpModulus(state.value, state.value);
+	backend.LowBits(state.value.Get(), state.value.Get(), m_blockBytes * 8);
+	backend.Xor(state.chain.Get(), state.value.Get(), state.chain.Get());
+}
+
+// Same text as BigInteger::ToString
+string MASH2::ChainToHex(BlockState & state) const {
+	m_backend->Export(state.chain.Get(), state.bytes.data(), state.bytes.size());
+	string digest = MessageToHex(string(state.bytes.begin(), state.bytes.end()));
+	size_t firstDigit = digest.find_first_not_of('0');
+	return "0x" + (firstDigit == string::npos ? string("0") : digest.substr(firstDigit));
+}
 
-	BigInteger shift = messageBitLength % (largest16Multiple >> 1) == ZERO ? 
-		ZERO 
-		: 
-		(largest16Multiple >> ONE) - messageBitLength % (largest16Multiple >> ONE);
-	
-	message <<= shift;
-
-	BigInteger twoPowMessage;
-	twoPowMessage = twoPowMessage.Pow(TWO, largest16Multiple);
-
-	BigInteger initVector = ZERO;
-	
-	BigInteger A = FIFTEEN * (TWO.Pow(TWO, largest16Multiple - FOUR));
-
-	BigInteger t = messageBitLength / (largest16Multiple >> ONE);
-	BigInteger prevInitVector;
-	for (BigInteger i = ZERO; i < t; i++) {
-		prevInitVector = initVector;
-		prevInitVector = ZERO;
-		BigInteger rem;
-		for (BigInteger j = (largest16Multiple / TWO) - FOUR; j >= ZERO; j -= FOUR) {
-			initVector = (initVector << FOUR) | FIFTEEN;
-			rem = (message >> (j + (largest16Multiple >> ONE) * (t - ONE - i))) % SIXTEEN;
-			if (rem < ZERO)
-				string halp = "HELP";
-			initVector = (initVector << FOUR) | rem;
+string MASH2::Digest(const string & msg) const {
+	TRACE_SCOPE("Digest");
+	const ArithBackend & backend = *m_backend;
+	const size_t halfBytes = m_blockBytes / 2;
+	const size_t halfBits = halfBytes * 8;
+	const uint8_t * bytes = reinterpret_cast<const uint8_t *>(msg.data());
+	size_t first = 0;
+	uint64_t messageBitLength = 0;
+	{
+		TRACE_SCOPE("Setup");
+		// The message is read as one big-endian integer, so leading zero bytes
+		// do not count towards its length
+		while (first < msg.length() && bytes[first] == 0) {
+			first++;
 		}
-		initVector ^= prevInitVector;
-		initVector |= A;
-		initVector = initVector.ExpMod(initVector, TWOFIFTYSEVEN, m_modulus);
-		initVector %= twoPowMessage;
-		initVector ^= prevInitVector;
+		if (first < msg.length()) {
+			uint32_t topBits = 0;
+			for (uint8_t top = bytes[first]; top != 0; top >>= 1) {
+				topBits++;
+			}
+			messageBitLength = (uint64_t)(msg.length() - first - 1) * 8 + topBits;
+		}
+		CheckMessageBits(messageBitLength);
 	}
-	// Assign the new previous initVector and reset initVector
-	prevInitVector = initVector;
-	initVector = ZERO;
-
-	BigInteger rem;
-	for (BigInteger j = (largest16Multiple / TWO) - FOUR; j >= ZERO; j -= FOUR) {
-		initVector = (initVector << FOUR) | TEN;
-		rem = (messageBitLength >> j) % SIXTEEN;
-		if (rem < ZERO)
-			string halp = "HELP";
-		initVector <<= FOUR;
-		initVector |= rem;
+
+	// Left-align the message on a multiple of n / 2 bits. Only the lowest
+	// floor(length / (n / 2)) blocks are hashed, most significant first.
+	vector<uint8_t> padded;
+	size_t blocks = (size_t)(messageBitLength / halfBits);
+	{
+		TRACE_SCOPE("Padding");
+		size_t shift = messageBitLength % halfBits == 0 ? 0 : halfBits - (size_t)(messageBitLength % halfBits);
+		padded.resize((size_t)((messageBitLength + shift) / 8));
+		ArithNumber message(backend);
+		backend.Import(message.Get(), bytes + first, msg.length() - first);
+		backend.ShiftLeft(message.Get(), message.Get(), shift);
+		backend.Export(message.Get(), padded.data(), padded.size());
 	}
-	if (A < ZERO)
-		string halp = "HELP";
-	initVector ^= prevInitVector;
-	initVector |= A;
-	initVector = initVector.ExpMod(initVector, TWOFIFTYSEVEN, m_modulus) % twoPowMessage;
-	initVector ^= prevInitVector;
-
-	return initVector.ToString();
-}
\ No newline at end of file
+
+	BlockState state;
+	InitState(state);
+	for (size_t i = 0; i < blocks; i++) {
+		Compress(state, padded.data() + padded.size() - (blocks - i) * halfBytes);
+	}
+	Finish(state, messageBitLength);
+	return ChainToHex(state);
+}
@@ -1,22 +1,81 @@
 #pragma once
+#include "ArithBackend.h"
 #include "BigInteger.h"
 #define MIN_STRONG_PRIME 513
 
+// Everything derived from the modulus that Digest needs. Can be persisted with
+// ParamFile so short-lived processes skip prime generation and setup.
+struct MASH2Params {
+	BigInteger modulus;
+	bool hasFactors;
+	BigInteger firstPrime;
+	BigInteger secPrime;
+	BigInteger secPrimeInv;		// secPrime^-1 mod firstPrime
+	BigInteger blockBits;		// n, the bit length of the modulus rounded down to a multiple of 16
+	BigInteger reduceModulus;	// 2^n
+	BigInteger padConstant;		// A = 15 * 2^(n - 4), the nibbles OR-ed into every expanded block
+	BigInteger maxMessageBits;	// 2^(n / 2)
+};
+
+class MASH2Mac;
+
+// Digest is const and keeps its working values on the caller's stack, so one
+// configured instance can be shared by any number of threads without copies or
+// locks. SetUseCrt and SetBackend are configuration: call them before sharing.
 class MASH2 {
+	// Drives the block steps directly from cached chaining values
+	friend class MASH2Mac;
 public:
 	MASH2();
-	string Digest(string message);
-	string MessageToHex(const string & message);
+	MASH2(const BigInteger & p, const BigInteger & q, bool useCrt = false);
+	explicit MASH2(const MASH2Params & params, bool useCrt = false);
+	string Digest(const string & message) const;
+	static string MessageToHex(const string & message);
+	void SetUseCrt(bool useCrt);
+	// Runs the per-block arithmetic on backend; GetArithBackend() until set
+	void SetBackend(const ArithBackend & backend);
+	const ArithBackend & Backend() const;
+	MASH2Params Parameters() const;
 private:
-	BigInteger ZERO;
-	BigInteger ONE;
-	BigInteger TWO;
-	BigInteger TEN;
-	BigInteger FIFTEEN;
-	BigInteger SIXTEEN;
-	BigInteger TWOFIFTYSEVEN;
-	
+	// Working values for one pass over the blocks, owned by the caller
+	struct BlockState {
+		ArithNumber chain;
+		ArithNumber value;
+		ArithNumber expanded;
+		vector<uint8_t> bytes;	// one expanded block, n / 8 bytes
+	};
+
+	void Init();
+	void InitPadding();
+	void ExpModulus(ArithNumber & result, const ArithNumber & base) const;
+	void ExpandBlock(const uint8_t * block, uint8_t highNibble, uint8_t * expanded) const;
+	void InitState(BlockState & state) const;
+	void CheckMessageBits(uint64_t messageBits) const;
+	void Compress(BlockState & state, const uint8_t * block) const;
+	void Finish(BlockState & state, uint64_t messageBits) const;
+	string ChainToHex(BlockState & state) const;
+
 	BigInteger m_modulus;
 	BigInteger firstPrime;
 	BigInteger secPrime;
+
+	// Chinese Remainder Theorem constants, only usable by holders of the factorization
+	bool m_hasFactors;
+	bool m_useCrt;
+	BigInteger m_secPrimeInv;	// secPrime^-1 mod firstPrime
+
+	// Padding constants, see MASH2Params
+	BigInteger m_blockBits;
+	BigInteger m_reduceModulus;
+	BigInteger m_padConstant;
+	BigInteger m_maxMessageBits;
+
+	// The constants above that Digest touches, held by the backend
+	const ArithBackend * m_backend;
+	size_t m_blockBytes;
+	ArithNumber m_modulusValue;
+	ArithNumber m_firstPrimeValue;
+	ArithNumber m_secPrimeValue;
+	ArithNumber m_secPrimeInvValue;
+	ArithNumber m_padValue;
 };
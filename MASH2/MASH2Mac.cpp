@@ -0,0 +1,69 @@
+#include "MASH2Mac.h"
+#include "Trace.h"
+
+MASH2Mac::MASH2Mac(const MASH2 & hash, const string & key) : m_hash(hash), m_backend(&hash.Backend()),
+	m_keyBytes(hash.m_blockBytes) {
+	vector<uint8_t> keyBlock(key.begin(), key.end());
+	// Keys longer than the key block are replaced by their hash, under the same
+	// length limit as any other message
+	if (keyBlock.size() > m_keyBytes) {
+		m_hash.CheckMessageBits((uint64_t)keyBlock.size() * 8);
+		MASH2::BlockState state;
+		m_hash.InitState(state);
+		Absorb(state, keyBlock.data(), keyBlock.size());
+		m_hash.Finish(state, (uint64_t)keyBlock.size() * 8);
+		keyBlock.resize(m_keyBytes);
+		m_hash.Backend().Export(state.chain.Get(), keyBlock.data(), keyBlock.size());
+	}
+	keyBlock.resize(m_keyBytes, 0);
+	m_innerChain = KeyChain(keyBlock, MAC_INNER_PAD);
+	m_outerChain = KeyChain(keyBlock, MAC_OUTER_PAD);
+}
+
+ArithNumber MASH2Mac::KeyChain(const vector<uint8_t> & key, uint8_t pad) const {
+	vector<uint8_t> padded(key);
+	for (size_t i = 0; i < padded.size(); i++) {
+		padded[i] ^= pad;
+	}
+	MASH2::BlockState state;
+	m_hash.InitState(state);
+	Absorb(state, padded.data(), padded.size());
+	return state.chain;
+}
+
+void MASH2Mac::Absorb(MASH2::BlockState & state, const uint8_t * bytes, size_t count) const {
+	const size_t halfBytes = m_hash.m_blockBytes / 2;
+	size_t whole = count - count % halfBytes;
+	for (size_t i = 0; i < whole; i += halfBytes) {
+		m_hash.Compress(state, bytes + i);
+	}
+	if (whole < count) {
+		vector<uint8_t> last(halfBytes, 0);
+		std::copy(bytes + whole, bytes + count, last.begin());
+		m_hash.Compress(state, last.data());
+	}
+}
+
+string MASH2Mac::Mac(const string & message) const {
+	TRACE_SCOPE("Mac");
+	if (&m_hash.Backend() != m_backend) {
+		throw new exception("ERROR: The hash backend changed after the MAC was keyed.");
+	}
+	// The key block counts towards each pass's length
+	uint64_t innerBits = ((uint64_t)m_keyBytes + message.length()) * 8;
+	m_hash.CheckMessageBits(innerBits);
+
+	MASH2::BlockState state;
+	m_hash.InitState(state);
+	state.chain = m_innerChain;
+	Absorb(state, reinterpret_cast<const uint8_t *>(message.data()), message.length());
+	m_hash.Finish(state, innerBits);
+
+	// The inner digest is exactly one key block long
+	vector<uint8_t> inner(m_keyBytes);
+	m_hash.Backend().Export(state.chain.Get(), inner.data(), inner.size());
+	state.chain = m_outerChain;
+	Absorb(state, inner.data(), inner.size());
+	m_hash.Finish(state, (uint64_t)m_keyBytes * 2 * 8);
+	return m_hash.ChainToHex(state);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "MASH2.h"
+
+// Inner and outer pad bytes, as in HMAC (RFC 2104)
+#define MAC_INNER_PAD 0x36
+#define MAC_OUTER_PAD 0x5c
+
+// HMAC-style keyed MAC over MASH2:
+//     Mac(m) = H((K ^ opad) || H((K ^ ipad) || m))
+// H runs the compression step over n / 2 bit blocks of the byte stream, zero-filling
+// the last one, then the usual length block. The key block is n / 8 bytes (two
+// compression blocks); longer keys are hashed down first. Both key blocks are
+// absorbed once at construction.
+//
+// This is not cheaper than Digest(key || message): each call still pays the two
+// length blocks and the two-block outer pass. It exists because Digest only hashes
+// the whole n / 2 bit blocks at the low end of the message and drops the bits above
+// them, which is exactly where a prepended key sits. Absorb zero-fills the last
+// block instead, so every key and message byte reaches the chain.
+//
+// Holds a reference to hash, which must outlive it. The key chains belong to the
+// backend hash had at construction, so Mac throws once SetBackend has changed it.
+// Errors are thrown as exception *, like Digest.
+// Mac is const, so one instance can be shared between threads like MASH2 itself.
+class MASH2Mac {
+public:
+	MASH2Mac(const MASH2 & hash, const string & key);
+	string Mac(const string & message) const;
+private:
+	// Continues state over bytes, zero-filling the final partial block
+	void Absorb(MASH2::BlockState & state, const uint8_t * bytes, size_t count) const;
+	// The chaining value after absorbing key ^ pad from the zero chain
+	ArithNumber KeyChain(const vector<uint8_t> & key, uint8_t pad) const;
+
+	const MASH2 & m_hash;
+	// The backend m_innerChain and m_outerChain were created on
+	const ArithBackend * m_backend;
+	size_t m_keyBytes;
+	ArithNumber m_innerChain;
+	ArithNumber m_outerChain;
+};
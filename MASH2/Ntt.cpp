@@ -0,0 +1,237 @@
+#include "Ntt.h"
+#include "WordMath.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+using std::exception;
+using std::vector;
+
+// Primes below 2^62 with a generator of the full multiplicative group:
+// 0x3fffc00000000001 = 65535 * 2^46 + 1 and 0x3fffbe0000000001 = 2097119 * 2^41 + 1.
+// The second caps the transform length at NTT_MAX_SIZE = 2^41. The product of the
+// two exceeds 2^123, so every coefficient (at most 2^41 terms below 2^64) is exact.
+struct NttPrime {
+	uint64_t mod;
+	uint64_t generator;
+};
+static const NttPrime NTT_PRIMES[2] = {
+	{ 0x3fffc00000000001ULL, 11 },
+	{ 0x3fffbe0000000001ULL, 3 }
+};
+
+static const uint64_t NTT_MAX_SIZE = 1ULL << 41;
+
+static std::atomic<unsigned> s_threads(1);
+
+// Montgomery arithmetic modulo a prime below 2^62 with R = 2^64. Values are kept
+// fully reduced; Mul(a, b) returns a * b / R mod p.
+class MontgomeryField {
+public:
+	explicit MontgomeryField(uint64_t mod) : m_mod(mod) {
+		// Newton iteration for mod^-1 mod 2^64, each step doubles the correct bits
+		uint64_t inverse = mod;
+		for (int i = 0; i < 5; i++) {
+			inverse *= 2 - mod * inverse;
+		}
+		m_negInverse = 0 - inverse;
+		m_r = (0 - mod) % mod;
+		m_r2 = m_r;
+		for (int i = 0; i < 64; i++) {
+			m_r2 = Add(m_r2, m_r2);
+		}
+	}
+
+	uint64_t Mod() const { return m_mod; }
+	uint64_t One() const { return m_r; }
+	uint64_t R2() const { return m_r2; }
+
+	uint64_t Add(uint64_t a, uint64_t b) const {
+		uint64_t sum = a + b;
+		return sum >= m_mod ? sum - m_mod : sum;
+	}
+
+	uint64_t Sub(uint64_t a, uint64_t b) const {
+		return a >= b ? a - b : a + m_mod - b;
+	}
+
+	uint64_t Mul(uint64_t a, uint64_t b) const {
+		uint64_t low;
+		uint64_t high = MulWide(a, b, low);
+		uint64_t m = low * m_negInverse;
+		uint64_t mLow;
+		uint64_t mHigh = MulWide(m, m_mod, mLow);
+		// low + mLow is 0 mod 2^64, so it carries exactly when low is non-zero
+		uint64_t result = high + mHigh + (low != 0);
+		return result >= m_mod ? result - m_mod : result;
+	}
+
+	uint64_t ToMont(uint64_t a) const {
+		return Mul(a, m_r2);
+	}
+
+	// base in Montgomery form, result in Montgomery form
+	uint64_t Pow(uint64_t base, uint64_t exp) const {
+		uint64_t result = m_r;
+		for (; exp; exp >>= 1) {
+			if (exp & 1) {
+				result = Mul(result, base);
+			}
+			base = Mul(base, base);
+		}
+		return result;
+	}
+
+private:
+	uint64_t m_mod;
+	uint64_t m_negInverse;
+	uint64_t m_r;
+	uint64_t m_r2;
+};
+
+// In-place forward transform of size n (a power of two). Data stays in the normal
+// domain because every twiddle is in Montgomery form. roots[j] = w^j for j < n / 2.
+static void Transform(uint64_t * data, size_t n, const MontgomeryField & field, const vector<uint64_t> & roots) {
+	// Bit-reversal permutation
+	for (size_t i = 1, j = 0; i < n; i++) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			std::swap(data[i], data[j]);
+		}
+	}
+	for (size_t len = 2; len <= n; len <<= 1) {
+		size_t half = len >> 1;
+		size_t step = n / len;
+		for (size_t i = 0; i < n; i += len) {
+			for (size_t j = 0; j < half; j++) {
+				uint64_t u = data[i + j];
+				uint64_t v = field.Mul(data[i + j + half], roots[j * step]);
+				data[i + j] = field.Add(u, v);
+				data[i + j + half] = field.Sub(u, v);
+			}
+		}
+	}
+}
+
+static void LoadOperand(const uint32_t * limbs, size_t count, size_t size, vector<uint64_t> & data) {
+	data.assign(size, 0);
+	for (size_t i = 0; i < count; i++) {
+		data[i] = limbs[i];
+	}
+}
+
+// Cyclic convolution of the two operands modulo one prime; result holds size values.
+static void ConvolveModPrime(const uint32_t * lhs, size_t lhsCount, const uint32_t * rhs, size_t rhsCount,
+	size_t size, const NttPrime & prime, bool parallelOperands, vector<uint64_t> & result) {
+	MontgomeryField field(prime.mod);
+	uint64_t root = field.Pow(field.ToMont(prime.generator), (prime.mod - 1) / size);
+	vector<uint64_t> roots(size / 2 > 0 ? size / 2 : 1);
+	roots[0] = field.One();
+	for (size_t j = 1; j < roots.size(); j++) {
+		roots[j] = field.Mul(roots[j - 1], root);
+	}
+
+	bool squaring = (lhs == rhs && lhsCount == rhsCount);
+	LoadOperand(lhs, lhsCount, size, result);
+	vector<uint64_t> other;
+	if (squaring) {
+		Transform(result.data(), size, field, roots);
+	}
+	else if (parallelOperands) {
+		std::thread worker([&]() {
+			LoadOperand(rhs, rhsCount, size, other);
+			Transform(other.data(), size, field, roots);
+		});
+		Transform(result.data(), size, field, roots);
+		worker.join();
+	}
+	else {
+		LoadOperand(rhs, rhsCount, size, other);
+		Transform(result.data(), size, field, roots);
+		Transform(other.data(), size, field, roots);
+	}
+	const vector<uint64_t> & rhsData = squaring ? result : other;
+
+	// Pointwise products pick up a factor of 1 / R
+	for (size_t i = 0; i < size; i++) {
+		result[i] = field.Mul(result[i], rhsData[i]);
+	}
+	// Inverse transform: forward transform, then reverse all but the first entry
+	Transform(result.data(), size, field, roots);
+	std::reverse(result.begin() + 1, result.end());
+
+	// Undo both the 1 / R and the factor of size: multiply by R^2 / size
+	uint64_t inverseSize = field.Pow(field.ToMont(size % prime.mod), prime.mod - 2);
+	uint64_t scale = field.Mul(inverseSize, field.R2());
+	for (size_t i = 0; i < size; i++) {
+		result[i] = field.Mul(result[i], scale);
+	}
+}
+
+void Ntt::Multiply(const uint32_t * lhs, size_t lhsCount, const uint32_t * rhs, size_t rhsCount, uint32_t * product) {
+	size_t productCount = lhsCount + rhsCount;
+	std::fill(product, product + productCount, 0);
+	if (lhsCount == 0 || rhsCount == 0) {
+		return;
+	}
+	if ((uint64_t)(productCount - 1) > NTT_MAX_SIZE) {
+		throw exception("ERROR: Operands are too long for the NTT.");
+	}
+	size_t size = 1;
+	while (size < productCount - 1) {
+		size <<= 1;
+	}
+
+	unsigned threads = s_threads.load(std::memory_order_relaxed);
+	bool parallel = threads >= 2 && size >= NTT_THREAD_MIN_SIZE;
+	bool parallelOperands = threads >= 4 && size >= NTT_THREAD_MIN_SIZE;
+	vector<uint64_t> first, second;
+	if (parallel) {
+		std::thread worker([&]() {
+			ConvolveModPrime(lhs, lhsCount, rhs, rhsCount, size, NTT_PRIMES[1], parallelOperands, second);
+		});
+		ConvolveModPrime(lhs, lhsCount, rhs, rhsCount, size, NTT_PRIMES[0], parallelOperands, first);
+		worker.join();
+	}
+	else {
+		ConvolveModPrime(lhs, lhsCount, rhs, rhsCount, size, NTT_PRIMES[0], false, first);
+		ConvolveModPrime(lhs, lhsCount, rhs, rhsCount, size, NTT_PRIMES[1], false, second);
+	}
+
+	// Garner: x = a1 + p1 * ((a2 - a1) * p1^-1 mod p2)
+	const uint64_t firstMod = NTT_PRIMES[0].mod;
+	MontgomeryField secondField(NTT_PRIMES[1].mod);
+	uint64_t firstInverse = secondField.Pow(secondField.ToMont(firstMod % secondField.Mod()), secondField.Mod() - 2);
+
+	// 128-bit running carry, emitted 32 bits at a time
+	uint64_t carryLow = 0;
+	uint64_t carryHigh = 0;
+	for (size_t i = 0; i < productCount; i++) {
+		if (i < productCount - 1) {
+			uint64_t diff = secondField.Sub(second[i], first[i] % secondField.Mod());
+			uint64_t t = secondField.Mul(diff, firstInverse);
+			uint64_t low;
+			uint64_t high = MulWide(firstMod, t, low);
+			low += first[i];
+			high += (low < first[i]);
+			carryLow += low;
+			carryHigh += high + (carryLow < low);
+		}
+		product[i] = (uint32_t)carryLow;
+		carryLow = (carryLow >> 32) | (carryHigh << 32);
+		carryHigh >>= 32;
+	}
+}
+
+void Ntt::SetThreads(unsigned threads) {
+	s_threads.store(threads == 0 ? 1 : threads, std::memory_order_relaxed);
+}
+
+unsigned Ntt::Threads() {
+	return s_threads.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// operator*= switches from schoolbook to the NTT once the shorter operand has at
+// least this many limbs, or NTT_MIN_SQUARE_LIMBS when squaring (one transform
+// fewer). Measured against operator*= itself on x86-64 with equal sized operands.
+// The NTT cost is flat from 513 to 1024 limbs (one 2048-point transform), and
+// schoolbook overtakes it near 920 limbs for products and 750 for squares. Squares
+// of 480 to 512 limbs also gain slightly but lose again just above 512.
+// Unbalanced products stay schoolbook since their cost is linear in the longer side.
+#define NTT_MIN_LIMBS 960
+#define NTT_MIN_SQUARE_LIMBS 768
+// Transforms at least this long are worth splitting across threads
+#define NTT_THREAD_MIN_SIZE (1 << 13)
+
+// Multiplication by number-theoretic transform. Each operand's 32-bit limbs are
+// convolved modulo two 62-bit primes with Montgomery arithmetic, then the exact
+// coefficients are rebuilt with the Chinese Remainder Theorem (Garner) and carried.
+class Ntt {
+public:
+	// product receives lhsCount + rhsCount limbs. Passing the same pointer and count
+	// for both operands squares, saving one forward transform.
+	static void Multiply(const uint32_t * lhs, size_t lhsCount, const uint32_t * rhs, size_t rhsCount, uint32_t * product);
+
+	// 1 (the default) keeps everything on the calling thread. 2 runs the two primes
+	// concurrently, 4 also transforms both operands concurrently.
+	static void SetThreads(unsigned threads);
+	static unsigned Threads();
+};
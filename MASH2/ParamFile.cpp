@@ -0,0 +1,243 @@
+#include "ParamFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char PARAM_MAGIC[8] = { 'M', 'A', 'S', 'H', '2', 'P', 'R', 'M' };
+static const uint32_t PARAM_ENDIAN_TAG = 0x01020304;
+// Bit length a modulus needs at least. Below 2^16 the block is empty (so Digest
+// would divide by zero) or as wide as the modulus itself.
+static const uint32_t PARAM_MIN_MODULUS_BITS = 17;
+
+static const BigInteger ONE(BigConstants::ONE);
+static const BigInteger FOUR(BigConstants::FOUR);
+static const BigInteger FIFTEEN(BigConstants::FIFTEEN);
+
+struct ParamFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t endianTag;
+	uint32_t flags;
+	uint32_t fieldCount;
+	uint64_t payloadBytes;
+	uint64_t checksum;
+};
+
+// FNV-1a, 64 bit
+static uint64_t Checksum(const unsigned char * data, size_t len) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < len; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static void AppendField(vector<uint32_t> & payload, const BigInteger & value) {
+	const LimbVector & limbs = value.Limbs();
+	payload.push_back((uint32_t)limbs.size());
+	payload.insert(payload.end(), limbs.begin(), limbs.end());
+}
+
+// Read-only view of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+	explicit MappedFile(const string & path);
+	~MappedFile();
+	const unsigned char * Data() const { return m_data; }
+	size_t Size() const { return m_size; }
+private:
+	MappedFile(const MappedFile &);
+	MappedFile & operator=(const MappedFile &);
+
+	const unsigned char * m_data;
+	size_t m_size;
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#endif
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile(const string & path) : m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) {
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		throw exception("ERROR: Cannot open parameter file.");
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+		CloseHandle(m_file);
+		throw exception("ERROR: Cannot read parameter file.");
+	}
+	m_size = (size_t)size.QuadPart;
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr) {
+		m_data = (const unsigned char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (m_data == nullptr) {
+		if (m_mapping != nullptr) {
+			CloseHandle(m_mapping);
+		}
+		CloseHandle(m_file);
+		throw exception("ERROR: Cannot map parameter file.");
+	}
+}
+
+MappedFile::~MappedFile() {
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+}
+#else
+MappedFile::MappedFile(const string & path) : m_data(nullptr), m_size(0) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw exception("ERROR: Cannot open parameter file.");
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		throw exception("ERROR: Cannot read parameter file.");
+	}
+	m_size = (size_t)info.st_size;
+	void * data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	close(fd);
+	if (data == MAP_FAILED) {
+		throw exception("ERROR: Cannot map parameter file.");
+	}
+	m_data = (const unsigned char *)data;
+}
+
+MappedFile::~MappedFile() {
+	munmap((void *)m_data, m_size);
+}
+#endif
+
+// Moves from over to, replacing any existing file in one step.
+static bool RenameOver(const string & from, const string & to) {
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// The padding fields must be the ones MASH2 derives from the modulus, and the
+// factors must multiply to it; Digest trusts all of them.
+static void Validate(const MASH2Params & params) {
+	uint32_t modulusBits = params.modulus.BitLength();
+	if (modulusBits < PARAM_MIN_MODULUS_BITS) {
+		throw exception("ERROR: Parameter file modulus is too small.");
+	}
+	BigInteger blockBits((int)((modulusBits >> 4) * 16));
+	if (params.blockBits != blockBits) {
+		throw exception("ERROR: Parameter file does not match its modulus.");
+	}
+	if (params.reduceModulus != (ONE << blockBits) || params.padConstant != FIFTEEN * (ONE << (blockBits - FOUR))
+		|| params.maxMessageBits != (ONE << (blockBits >> ONE))) {
+		throw exception("ERROR: Parameter file does not match its modulus.");
+	}
+	if (params.hasFactors && (params.firstPrime * params.secPrime != params.modulus
+		|| (params.secPrime * params.secPrimeInv) % params.firstPrime != ONE)) {
+		throw exception("ERROR: Parameter file factors do not match its modulus.");
+	}
+}
+
+void ParamFile::Save(const string & path, const MASH2Params & params) {
+	vector<uint32_t> payload;
+	BigInteger empty = BigInteger::FromLimbs(nullptr, 0);
+	AppendField(payload, params.modulus);
+	AppendField(payload, params.hasFactors ? params.firstPrime : empty);
+	AppendField(payload, params.hasFactors ? params.secPrime : empty);
+	AppendField(payload, params.hasFactors ? params.secPrimeInv : empty);
+	AppendField(payload, params.blockBits);
+	AppendField(payload, params.reduceModulus);
+	AppendField(payload, params.padConstant);
+	AppendField(payload, params.maxMessageBits);
+
+	ParamFileHeader header;
+	memcpy(header.magic, PARAM_MAGIC, sizeof(header.magic));
+	header.version = PARAM_FILE_VERSION;
+	header.endianTag = PARAM_ENDIAN_TAG;
+	header.flags = params.hasFactors ? PARAM_FLAG_FACTORS : 0;
+	header.fieldCount = PARAM_FIELD_COUNT;
+	header.payloadBytes = payload.size() * sizeof(uint32_t);
+	header.checksum = Checksum((const unsigned char *)payload.data(), (size_t)header.payloadBytes);
+
+	// Written beside the target and renamed over it, so readers never see a partial file
+	string tempPath = path + ".tmp";
+	std::ofstream file(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)payload.data(), (std::streamsize)header.payloadBytes);
+	file.close();
+	if (!file) {
+		remove(tempPath.c_str());
+		throw exception("ERROR: Cannot write parameter file.");
+	}
+	if (!RenameOver(tempPath, path)) {
+		remove(tempPath.c_str());
+		throw exception("ERROR: Cannot replace parameter file.");
+	}
+}
+
+MASH2Params ParamFile::Load(const string & path) {
+	MappedFile file(path);
+	ParamFileHeader header;
+	if (file.Size() < sizeof(header)) {
+		throw exception("ERROR: Parameter file is truncated.");
+	}
+	memcpy(&header, file.Data(), sizeof(header));
+	if (memcmp(header.magic, PARAM_MAGIC, sizeof(header.magic)) != 0) {
+		throw exception("ERROR: Not a MASH2 parameter file.");
+	}
+	if (header.version != PARAM_FILE_VERSION || header.endianTag != PARAM_ENDIAN_TAG
+		|| header.fieldCount != PARAM_FIELD_COUNT) {
+		throw exception("ERROR: Unsupported parameter file version.");
+	}
+	if (header.payloadBytes != file.Size() - sizeof(header) || header.payloadBytes % sizeof(uint32_t) != 0) {
+		throw exception("ERROR: Parameter file is truncated.");
+	}
+	const unsigned char * payload = file.Data() + sizeof(header);
+	if (Checksum(payload, (size_t)header.payloadBytes) != header.checksum) {
+		throw exception("ERROR: Parameter file checksum mismatch.");
+	}
+
+	// The header is 8-byte sized and the mapping page aligned, so limbs can be read in place
+	const uint32_t * words = (const uint32_t *)payload;
+	size_t wordCount = (size_t)(header.payloadBytes / sizeof(uint32_t));
+	size_t pos = 0;
+	BigInteger fields[PARAM_FIELD_COUNT];
+	for (int i = 0; i < PARAM_FIELD_COUNT; i++) {
+		if (pos >= wordCount || words[pos] > wordCount - pos - 1) {
+			throw exception("ERROR: Parameter file is truncated.");
+		}
+		size_t limbCount = words[pos];
+		fields[i] = BigInteger::FromLimbs(words + pos + 1, limbCount);
+		pos += limbCount + 1;
+	}
+
+	MASH2Params params;
+	params.modulus = fields[0];
+	params.hasFactors = (header.flags & PARAM_FLAG_FACTORS) != 0;
+	if (params.hasFactors) {
+		params.firstPrime = fields[1];
+		params.secPrime = fields[2];
+		params.secPrimeInv = fields[3];
+	}
+	params.blockBits = fields[4];
+	params.reduceModulus = fields[5];
+	params.padConstant = fields[6];
+	params.maxMessageBits = fields[7];
+	Validate(params);
+	return params;
+}
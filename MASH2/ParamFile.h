@@ -0,0 +1,26 @@
+#pragma once
+#include "MASH2.h"
+
+// On-disk MASH-2 parameters. Layout (all integers little-endian):
+//     char     magic[8]        "MASH2PRM"
+//     uint32   version         PARAM_FILE_VERSION
+//     uint32   endianTag       0x01020304, rejects files from other byte orders
+//     uint32   flags           PARAM_FLAG_FACTORS when the factorization is present
+//     uint32   fieldCount      PARAM_FIELD_COUNT
+//     uint64   payloadBytes
+//     uint64   checksum        FNV-1a 64 of the payload
+//     payload                  per field: uint32 limbCount, then limbCount uint32 limbs
+// Fields follow MASH2Params order. Factor fields are empty when the flag is clear.
+#define PARAM_FILE_VERSION 1
+#define PARAM_FLAG_FACTORS 1
+#define PARAM_FIELD_COUNT 8
+
+class ParamFile {
+public:
+	// Writes path + ".tmp" and renames it over path, so an interrupted save leaves
+	// the previous file intact
+	static void Save(const string & path, const MASH2Params & params);
+	// Maps the file read-only and rebuilds the parameters straight from the mapping.
+	// Throws unless the padding fields (and factors, if present) match the modulus.
+	static MASH2Params Load(const string & path);
+};
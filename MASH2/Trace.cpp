@@ -0,0 +1,108 @@
+#include "Trace.h"
+#include <fstream>
+#include <cstdio>
+
+std::atomic<bool> Trace::s_enabled(false);
+
+// Every thread's buffer, so the exporter can find them. Buffers are never freed
+// so spans from finished threads still show up in the dump.
+static std::mutex s_registryLock;
+static vector<TraceBuffer *> s_registry;
+static uint32_t s_nextThreadId = 1;
+
+TraceBuffer::TraceBuffer(uint32_t threadId) : m_events(TRACE_BUFFER_SPANS), m_written(0), m_threadId(threadId) {
+}
+
+void TraceBuffer::Record(const char * name, uint64_t startNs, uint64_t durationNs) {
+	uint64_t index = m_written.load(std::memory_order_relaxed);
+	TraceEvent & ev = m_events[index % m_events.size()];
+	ev.name = name;
+	ev.startNs = startNs;
+	ev.durationNs = durationNs;
+	// Publish the slot after it is filled in
+	m_written.store(index + 1, std::memory_order_release);
+}
+
+uint32_t TraceBuffer::ThreadId() const {
+	return m_threadId;
+}
+
+vector<TraceEvent> TraceBuffer::Events() const {
+	uint64_t written = m_written.load(std::memory_order_acquire);
+	uint64_t count = written < m_events.size() ? written : m_events.size();
+	vector<TraceEvent> events;
+	events.reserve((size_t)count);
+	for (uint64_t i = written - count; i < written; i++) {
+		events.push_back(m_events[i % m_events.size()]);
+	}
+	return events;
+}
+
+void TraceBuffer::Clear() {
+	m_written.store(0, std::memory_order_release);
+}
+
+void Trace::Enable(bool enabled) {
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Nanoseconds on a monotonic clock
+uint64_t Trace::NowNs() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Lazily creates and registers the calling thread's buffer.
+TraceBuffer & Trace::ThreadBuffer() {
+	thread_local TraceBuffer * buffer = nullptr;
+	if (buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(s_registryLock);
+		buffer = new TraceBuffer(s_nextThreadId++);
+		s_registry.push_back(buffer);
+	}
+	return *buffer;
+}
+
+// Emits complete ("X") events. Chrome expects microseconds, so the nanosecond
+// timestamps are written with three decimal places.
+void Trace::WriteChromeJson(ostream & os) {
+	std::lock_guard<std::mutex> lock(s_registryLock);
+	bool first = true;
+	char number[32];
+
+	os << "{\"traceEvents\":[";
+	for (size_t b = 0; b < s_registry.size(); b++) {
+		vector<TraceEvent> events = s_registry[b]->Events();
+		for (size_t i = 0; i < events.size(); i++) {
+			if (!first) {
+				os << ",";
+			}
+			first = false;
+			os << "\n{\"name\":\"" << events[i].name << "\",\"cat\":\"mash2\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+				<< s_registry[b]->ThreadId();
+			snprintf(number, sizeof(number), "%llu.%03llu",
+				(unsigned long long)(events[i].startNs / 1000), (unsigned long long)(events[i].startNs % 1000));
+			os << ",\"ts\":" << number;
+			snprintf(number, sizeof(number), "%llu.%03llu",
+				(unsigned long long)(events[i].durationNs / 1000), (unsigned long long)(events[i].durationNs % 1000));
+			os << ",\"dur\":" << number << "}";
+		}
+	}
+	os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+bool Trace::WriteChromeJson(const string & path) {
+	std::ofstream file(path.c_str());
+	if (!file) {
+		return false;
+	}
+	WriteChromeJson(file);
+	return (bool)file;
+}
+
+void Trace::Clear() {
+	std::lock_guard<std::mutex> lock(s_registryLock);
+	for (size_t b = 0; b < s_registry.size(); b++) {
+		s_registry[b]->Clear();
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+using std::ostream;
+using std::string;
+using std::vector;
+
+// Number of spans each thread keeps before the oldest are overwritten
+#define TRACE_BUFFER_SPANS 4096
+
+// Opens a span that closes at the end of the enclosing scope. Costs a single
+// relaxed load and branch while tracing is disabled.
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+// A finished span. Name must be a string literal (or otherwise outlive the dump).
+struct TraceEvent {
+	const char * name;
+	uint64_t startNs;
+	uint64_t durationNs;
+};
+
+// Fixed size ring of spans owned by a single thread.
+class TraceBuffer {
+public:
+	explicit TraceBuffer(uint32_t threadId);
+	void Record(const char * name, uint64_t startNs, uint64_t durationNs);
+	uint32_t ThreadId() const;
+	// Oldest first
+	vector<TraceEvent> Events() const;
+	void Clear();
+private:
+	vector<TraceEvent> m_events;
+	std::atomic<uint64_t> m_written;
+	uint32_t m_threadId;
+};
+
+// Process wide switch and exporter for the per-thread trace buffers.
+class Trace {
+public:
+	static void Enable(bool enabled);
+	static bool IsEnabled();
+	static uint64_t NowNs();
+	static TraceBuffer & ThreadBuffer();
+
+	// Writes every thread's spans as Chrome trace_event JSON (chrome://tracing,
+	// Perfetto). Call once traced work has quiesced.
+	static void WriteChromeJson(ostream & os);
+	static bool WriteChromeJson(const string & path);
+	static void Clear();
+private:
+	static std::atomic<bool> s_enabled;
+};
+
+// RAII span: timestamps on construction and records on destruction.
+class TraceSpan {
+public:
+	explicit TraceSpan(const char * name);
+	~TraceSpan();
+private:
+	TraceSpan(const TraceSpan &);
+	TraceSpan & operator=(const TraceSpan &);
+
+	const char * m_name;
+	uint64_t m_startNs;
+};
+
+inline bool Trace::IsEnabled() {
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+inline TraceSpan::TraceSpan(const char * name) : m_name(nullptr), m_startNs(0) {
+	if (Trace::IsEnabled()) {
+		m_name = name;
+		m_startNs = Trace::NowNs();
+	}
+}
+
+inline TraceSpan::~TraceSpan() {
+	// Spans opened while disabled stay disabled even if tracing is switched on mid-scope
+	if (m_name != nullptr) {
+		Trace::ThreadBuffer().Record(m_name, m_startNs, Trace::NowNs() - m_startNs);
+	}
+}
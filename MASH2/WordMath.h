@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Full 64 x 64 -> 128 bit product, returns the high half
+inline uint64_t MulWide(uint64_t a, uint64_t b, uint64_t & low) {
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 prod = (unsigned __int128)a * b;
+	low = (uint64_t)prod;
+	return (uint64_t)(prod >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	uint64_t high;
+	low = _umul128(a, b, &high);
+	return high;
+#else
+	uint64_t aLow = (uint32_t)a, aHigh = a >> 32;
+	uint64_t bLow = (uint32_t)b, bHigh = b >> 32;
+	uint64_t lowLow = aLow * bLow;
+	uint64_t highLow = aHigh * bLow;
+	uint64_t lowHigh = aLow * bHigh;
+	uint64_t middle = (lowLow >> 32) + (uint32_t)highLow + (uint32_t)lowHigh;
+	low = (middle << 32) | (uint32_t)lowLow;
+	return aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+}
@@ -1,5 +1,9 @@
+#include "BackendBench.h"
 #include "BigInteger.h"
 #include "MASH2.h"
+#include "ParamFile.h"
+#include "Trace.h"
+#include <cstdlib>
 #include <iostream>
 using std::cout;
 using std::cin;
@@ -18,13 +22,47 @@ int main() {
 	//top |= bottom;
 	//cout << top << std::endl;
 	//cout << (top - BigInteger("1")).InvertBits().ToString() << std::endl;
-	///*if (p.RabinMillerTest(p, 5))
+	///*if (BigInteger::RabinMillerTest(p, 5))
 	//	cout << "Success";
 	//else
 	//	cout << "Fail";*/
 
+	// MASH2_TRACE=<file> records the digest phases as Chrome trace JSON
+	const char * tracePath = std::getenv("MASH2_TRACE");
+	if (tracePath != nullptr) {
+		Trace::Enable(true);
+	}
+
+	// MASH2_BACKEND=<backend> selects the arithmetic for every digest below
+	const char * backendName = std::getenv("MASH2_BACKEND");
+	if (backendName != nullptr && FindArithBackend(backendName) == nullptr) {
+		cout << "Unknown arithmetic backend: " << backendName << std::endl;
+		return 1;
+	}
+
+	// MASH2_BENCH=<backend> checks that backend against native and reports both
+	// throughputs. MASH2_PARAMS=<file> benchmarks saved parameters instead.
+	const char * benchBackend = std::getenv("MASH2_BENCH");
+	if (benchBackend != nullptr) {
+		const ArithBackend * backend = FindArithBackend(benchBackend);
+		if (backend == nullptr) {
+			cout << "Unknown arithmetic backend: " << benchBackend << std::endl;
+			return 1;
+		}
+		const char * paramPath = std::getenv("MASH2_PARAMS");
+		MASH2Params params = paramPath != nullptr ? ParamFile::Load(string(paramPath)) : MASH2().Parameters();
+		// Roughly four blocks of n / 2 bits per message
+		size_t messageBytes = std::max<size_t>(1, params.blockBits.Limbs()[0] / 16 * 4);
+		BackendBenchResult result = BackendBench::Run(params, NativeArithBackend(), *backend, 1000, messageBytes, cout);
+		return result.mismatches == 0 ? 0 : 1;
+	}
+
 	MASH2 mash2 = MASH2();
 	mash2.Digest("Help");
+
+	if (tracePath != nullptr) {
+		Trace::WriteChromeJson(string(tracePath));
+	}
 	return 0;
 }
 